@@ -0,0 +1,56 @@
+#include "ab_test.hpp"
+
+std::vector<float> parse_params(const std::string& s){
+    std::vector<float> res;
+    std::stringstream ss(s);
+    std::string item;
+    while (std::getline(ss, item, ',')) res.push_back(atof(item.c_str()));
+    assert (res.size() == 6);
+    return res;
+}
+
+// ab-test success|score depth min_prob effect max_pairs params_a params_b [initial_pos terminal_rank n_gens]
+//     params are comma separated, e.g. 50,300,20,5,3,2
+//     initial_pos is hexadecimal, e.g. FECDBA89
+int main(int argc, char *argv[]) {
+    assert ((argc == 8) || (argc == 11));
+    
+    sprt_config config;
+    config.metric = (std::string(argv[1]) == "score") ? MEAN_SCORE : SUCCESS_RATE;
+    
+    // full games never reach a terminal rank, so success is only measured on transitions
+    if ((config.metric == SUCCESS_RATE) && (argc != 11)){
+        std::cerr << "success mode needs initial_pos terminal_rank n_gens" << std::endl;
+        return 1;
+    }
+    config.effect = atof(argv[4]);
+    config.max_pairs = atoi(argv[5]);
+    
+    board_t initial_pos = 0;
+    size_t terminal_rank = 17; // unreachable, full games are played to the end
+    size_t n_gens = 2;
+    
+    if (argc == 11){
+        initial_pos = strtoull(argv[8], nullptr, 16);
+        terminal_rank = atoi(argv[9]);
+        n_gens = atoi(argv[10]);
+    }
+    
+    // 65536 (rank 16) is the largest tile a game can make
+    if ((config.metric == SUCCESS_RATE) && (terminal_rank > 16)){
+        std::cerr << "terminal_rank must be at most 16" << std::endl;
+        return 1;
+    }
+    
+    sprt_state res = ab_test(config, atoi(argv[2]), atof(argv[3]), parse_params(argv[6]), parse_params(argv[7]), initial_pos, terminal_rank, n_gens);
+    
+    std::cout << "Pairs: " << res.n_pairs << std::endl;
+    if (config.metric == SUCCESS_RATE){
+        std::cout << "Only A succeeded: " << res.a_only << std::endl;
+        std::cout << "Only B succeeded: " << res.b_only << std::endl;
+    } else {
+        std::cout << "Mean score difference (B - A): " << res.sum_diff / res.n_pairs << std::endl;
+    }
+    std::cout << "Decision: " << ((res.decision == 1) ? "accept B" : (res.decision == -1) ? "reject B" : "undecided") << std::endl;
+    return 0;
+}
@@ -0,0 +1,27 @@
+#include "stats.hpp"
+
+// aggregate-results [-o merged.shard] files...
+//     files may be text results (.txt), binary records (.rec) or shards (.shard) from other hosts
+int main(int argc, char *argv[]) {
+    assert (argc >= 2);
+    std::string shard_path;
+    result_stats stats;
+    
+    for (int i = 1; i < argc; ++i){
+        std::string arg = argv[i];
+        if (arg == "-o"){
+            assert (i + 1 < argc);
+            shard_path = argv[++i];
+        } else {
+            stats.add_file(arg);
+        }
+    }
+    
+    if (!shard_path.empty()){
+        std::ofstream out(shard_path);
+        stats.save(out);
+    }
+    
+    stats.report(std::cout);
+    return 0;
+}
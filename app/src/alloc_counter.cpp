@@ -0,0 +1,45 @@
+#include "alloc_counter.hpp"
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+static std::atomic<u_int64_t> n_allocations(0);
+
+u_int64_t allocation_count(){
+    return n_allocations.load(std::memory_order_relaxed);
+}
+
+void* operator new(size_t n){
+    n_allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* ptr = std::malloc(n ? n : 1)) return ptr;
+    throw std::bad_alloc();
+}
+
+void* operator new[](size_t n){
+    return operator new(n);
+}
+
+void* operator new(size_t n, const std::nothrow_t&) noexcept {
+    n_allocations.fetch_add(1, std::memory_order_relaxed);
+    return std::malloc(n ? n : 1);
+}
+
+void* operator new[](size_t n, const std::nothrow_t&) noexcept {
+    return operator new(n, std::nothrow);
+}
+
+void operator delete(void* ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete[](void* ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept {
+    std::free(ptr);
+}
+
+void operator delete[](void* ptr, size_t) noexcept {
+    std::free(ptr);
+}
@@ -0,0 +1,7 @@
+#pragma once
+#include <sys/types.h>
+
+// number of heap allocations made through operator new by any thread since the program started.
+// alloc_counter.cpp replaces the global operator new and delete with counting versions in every program it is compiled into,
+// so it is only added to the targets that report allocations
+u_int64_t allocation_count();
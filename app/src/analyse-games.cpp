@@ -0,0 +1,9 @@
+#include "analysis.hpp"
+
+// analyse-games depth min_prob blunder_threshold output_file records.rec...
+int main(int argc, char *argv[]) {
+    assert (argc >= 6);
+    std::vector<std::string> record_paths(argv + 5, argv + argc);
+    analyse_records(record_paths, argv[4], atoi(argv[1]), atof(argv[2]), atof(argv[3]), std::thread::hardware_concurrency());
+    return 0;
+}
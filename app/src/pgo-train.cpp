@@ -0,0 +1,90 @@
+#include "alloc_counter.hpp"
+#include "game.hpp"
+
+// fixed workload used to collect branch profiles and to time builds against each other.
+// every game is seeded, so repeated runs (and different builds) search the same positions.
+
+// expectimax over the opening of fresh games and over the endgame transitions studied in test-game-params
+// the first game warms up the search arenas and worker threads, every later move is steady state
+u_int64_t train_expectimax(trans_table& T, const size_t& scale, long long& score_checksum, u_int64_t& n_steady_moves, u_int64_t& n_steady_allocs){
+    const int depth = 6;
+    const float min_prob = 0.01;
+    const size_t n_moves = 40;
+    
+    struct scenario {board_t initial_pos; size_t n_gens;};
+    const std::vector<scenario> scenarios = {{0, 2}, {0xFECD, 4}, {0xEDBC, 4}, {0xDCAB, 4}};
+    
+    u_int64_t evals_start = T.b_eval_count.load();
+    for (size_t i = 0; i < scale; ++i){
+        for (size_t s = 0; s < scenarios.size(); ++s){
+            spawn_rng rng(1000 * i + s);
+            Board B = Board(scenarios[s].initial_pos);
+            for (size_t j = 0; j < scenarios[s].n_gens; ++j) B.generate_piece(rng);
+            
+            bool warmup = (i == 0) && (s == 0);
+            u_int64_t allocs_start = allocation_count();
+            
+            for (size_t j = 0; (j < n_moves) && !B.is_terminal(); ++j){
+                B.move(T.expectimax(B, depth, min_prob), rng);
+                if (!warmup) ++n_steady_moves;
+            }
+            if (!warmup) n_steady_allocs += allocation_count() - allocs_start;
+            score_checksum += B.score();
+        }
+    }
+    return T.b_eval_count.load() - evals_start;
+}
+
+// monte carlo rollouts, which exercise the random move and spawn paths
+u_int64_t train_mcts(trans_table& T, const size_t& scale, long long& score_checksum){
+    const size_t n_sims = 500;
+    const size_t n_moves = 20;
+    u_int64_t n_rollouts = 0;
+    
+    for (size_t i = 0; i < scale; ++i){
+        srand((u_int32_t) i);
+        spawn_rng rng(i);
+        Board B = Board();
+        B.generate_piece(rng);
+        B.generate_piece(rng);
+        
+        for (size_t j = 0; (j < n_moves) && !B.is_terminal(); ++j){
+            n_rollouts += n_sims * B.valid_moves().size();
+            B.move(T.mcts(B, n_sims), rng);
+        }
+        score_checksum += B.score();
+    }
+    return n_rollouts;
+}
+
+int main(int argc, char *argv[]) {
+    assert ((argc == 1) | (argc == 2));
+    size_t scale = (argc == 2) ? atoi(argv[1]) : 2;
+    
+    std::unique_ptr<trans_table> T(new trans_table());
+    long long expectimax_checksum = 0;
+    long long mcts_checksum = 0;
+    u_int64_t n_steady_moves = 0;
+    u_int64_t n_steady_allocs = 0;
+    
+    auto start = std::chrono::steady_clock::now();
+    u_int64_t n_evals = train_expectimax(*T, scale, expectimax_checksum, n_steady_moves, n_steady_allocs);
+    float expectimax_s = std::chrono::duration<float>(std::chrono::steady_clock::now() - start).count();
+    
+    start = std::chrono::steady_clock::now();
+    u_int64_t n_rollouts = train_mcts(*T, scale, mcts_checksum);
+    float mcts_s = std::chrono::duration<float>(std::chrono::steady_clock::now() - start).count();
+    
+    // the expectimax checksum must match between builds, mcts rollouts share rand() between threads
+    std::cout << "Expectimax: " << n_evals << " evals in " << expectimax_s << "s ("
+    << (u_int64_t) (n_evals / expectimax_s) << " evals/s), score checksum " << expectimax_checksum << std::endl;
+    std::cout << "Steady state: " << n_steady_allocs << " allocations over " << n_steady_moves << " moves ("
+    << (n_steady_moves ? (float) n_steady_allocs / n_steady_moves : 0) << " per move)" << std::endl;
+    std::cout << "Leaf cache: " << T->leaf_hits.load() << " hits over " << T->leaf_lookups.load() << " lookups ("
+    << (T->leaf_lookups.load() ? 100.0 * T->leaf_hits.load() / T->leaf_lookups.load() : 0) << "%)" << std::endl;
+    std::cout << "MCTS: " << n_rollouts << " rollouts in " << mcts_s << "s ("
+    << (u_int64_t) (n_rollouts / mcts_s) << " rollouts/s), score checksum " << mcts_checksum << std::endl;
+    std::cout << "Total: " << expectimax_s + mcts_s << "s" << std::endl;
+    
+    return 0;
+}
@@ -0,0 +1,80 @@
+#include "game.hpp"
+#include <cstring>
+
+// replay verify records.rec
+//     rebuilds every game and checks legality and final scores
+// replay render records.rec game_idx [frame_ms]
+//     renders a single recorded game
+// replay stream records.rec
+//     writes every position to stdout as (board_t board, u_int8_t move) pairs
+int main(int argc, char *argv[]) {
+    assert (argc >= 3);
+    std::string mode = argv[1];
+    std::ifstream in(argv[2], std::ios::binary);
+    assert (in.is_open());
+    
+    record_reader reader(in);
+    game_record record;
+    
+    if (mode == "render") {
+        assert ((argc == 4) | (argc == 5));
+        size_t game_idx = atoi(argv[3]);
+        int frame_ms = (argc == 5) ? atoi(argv[4]) : 50;
+        
+        for (size_t i = 0; i <= game_idx; ++i){
+            if (!reader.next(record)) {
+                std::cerr << "Record " << game_idx << " not found" << std::endl;
+                return 1;
+            }
+        }
+        display_record(record, frame_ms);
+        return 0;
+    }
+    
+    if (mode == "stream") {
+        char out[9];
+        std::vector<char> buf;
+        
+        while (reader.next(record)){
+            buf.clear();
+            replay_record(record, [&](const Board& B, const u_int32_t&, const ply_record& p){
+                std::memcpy(out, &B.board, 8);
+                out[8] = p.move;
+                buf.insert(buf.end(), out, out + 9);
+            });
+            std::cout.write(buf.data(), buf.size());
+        }
+        return 0;
+    }
+    
+    assert (mode == "verify");
+    size_t n_games = 0;
+    size_t n_plies = 0;
+    size_t n_failures = 0;
+    board_t checksum = 0;
+    auto start = std::chrono::steady_clock::now();
+    
+    while (reader.next(record)){
+        replay_result res = replay_record(record, [&](const Board& B, const u_int32_t&, const ply_record&){
+            checksum ^= B.board;
+        });
+        
+        if (!res.legal || !res.score_matches){
+            ++n_failures;
+            std::cout << "Game " << n_games << " (seed=" << record.header.seed << "): "
+                << (res.legal ? "" : "illegal ply " + std::to_string(res.n_plies) + " ")
+                << (res.score_matches ? "" : "score mismatch ")
+                << "{recorded=" << record.header.final_score << ", replayed=" << res.score << "}" << std::endl;
+        }
+        
+        ++n_games;
+        n_plies += res.n_plies;
+    }
+    
+    float seconds = std::chrono::duration<float>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "Games: " << n_games << std::endl;
+    std::cout << "Plies: " << n_plies << std::endl;
+    std::cout << "Failures: " << n_failures << std::endl;
+    std::cout << "Plies/s: " << std::setprecision(4) << n_plies / seconds << " (checksum " << std::hex << checksum << std::dec << ")" << std::endl;
+    return n_failures ? 1 : 0;
+}
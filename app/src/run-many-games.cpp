@@ -1,10 +1,27 @@
 #include "game.hpp"
 
+// run-many-games depth min_prob n_games output_folder [n_interleaved]
+// run-many-games nodes|time budget n_games output_folder [max_depth]
 int main(int argc, char *argv[]) {
-    assert (argc == 5);
+    std::string mode = (argc > 1) ? argv[1] : "";
+    
+    // per move budget of board evaluations or microseconds instead of a fixed depth and min_prob
+    if ((mode == "nodes") || (mode == "time")){
+        assert ((argc == 5) || (argc == 6));
+        std::stringstream s;
+        s << argv[4];
+        int max_depth = (argc == 6) ? atoi(argv[5]) : 8;
+        u_int64_t budget = atoll(argv[2]);
+        budget_controller controller = (mode == "nodes") ? budget_controller(budget, max_depth) : budget_controller::for_time(budget, max_depth);
+        test_budget(controller, mode + " " + argv[2], atoi(argv[3]), s);
+        return 0;
+    }
+    
+    assert ((argc == 5) || (argc == 6));
     std::stringstream s;
     s << argv[4];
-    test_params(atoi(argv[1]), atof(argv[2]), atoi(argv[3]), s);
+    size_t n_interleaved = (argc == 6) ? atoi(argv[5]) : 1;
+    test_params(parse_depth_schedule(argv[1]), atof(argv[2]), atoi(argv[3]), s, n_interleaved);
     return 0;
 
 }
@@ -0,0 +1,103 @@
+#include "multi_trans_table.hpp"
+#include "game.hpp"
+#include <cstring>
+
+// reads (board_t board, u_int8_t move) pairs written by `replay stream`
+std::vector<std::pair<board_t, DIRECTION>> read_positions(const std::string& path, size_t max_positions){
+    std::vector<std::pair<board_t, DIRECTION>> res;
+    std::ifstream in(path, std::ios::binary);
+    char buf[9];
+    board_t board;
+    
+    while ((res.size() < max_positions) && in.read(buf, 9)){
+        std::memcpy(&board, buf, 8);
+        res.push_back({board, (DIRECTION) buf[8]});
+    }
+    return res;
+}
+
+std::vector<std::vector<float>> read_param_sets(const std::string& path){
+    std::vector<std::vector<float>> res;
+    std::ifstream in(path);
+    std::string line;
+    
+    while (std::getline(in, line)){
+        std::vector<float> params;
+        std::replace(line.begin(), line.end(), ',', ' ');
+        std::stringstream ss(line);
+        float x;
+        while (ss >> x) params.push_back(x);
+        if (params.size() == 6) res.push_back(params);
+    }
+    return res;
+}
+
+template <size_t K>
+void screen(std::vector<std::vector<float>> param_sets, const std::vector<std::pair<board_t, DIRECTION>>& positions, int depth, float min_prob, bool compare){
+    size_t n_sets = param_sets.size();
+    while (param_sets.size() < K) param_sets.push_back(param_sets.back());
+    
+    std::unique_ptr<multi_trans_table<K>> M(new multi_trans_table<K>(param_sets));
+    std::vector<size_t> agreement(n_sets, 0);
+    std::vector<std::array<DIRECTION, K>> choices;
+    
+    auto start = std::chrono::steady_clock::now();
+    for (auto& p : positions){
+        choices.push_back(M->expectimax(Board(p.first), depth, min_prob));
+        for (size_t k = 0; k < n_sets; ++k) agreement[k] += (choices.back()[k] == p.second);
+    }
+    float multi_seconds = std::chrono::duration<float>(std::chrono::steady_clock::now() - start).count();
+    
+    for (size_t k = 0; k < n_sets; ++k){
+        std::cout << "Params:" << param_sets[k] << " agreement with played move: ";
+        std::cout << std::setprecision(4) << 100.0 * agreement[k] / positions.size() << "%" << std::endl;
+    }
+    std::cout << "Positions: " << positions.size() << ", sets: " << n_sets << " (walk width " << K << ")" << std::endl;
+    std::cout << "Shared walk: " << multi_seconds << "s" << std::endl;
+    
+    if (!compare) return;
+    
+    // one full search per parameter set, which the shared walk must reproduce exactly
+    size_t mismatches = 0;
+    start = std::chrono::steady_clock::now();
+    for (size_t k = 0; k < n_sets; ++k){
+        std::unique_ptr<trans_table> T(new trans_table(param_sets[k]));
+        for (size_t i = 0; i < positions.size(); ++i){
+            mismatches += (T->expectimax(Board(positions[i].first), depth, min_prob) != choices[i][k]);
+        }
+    }
+    float separate_seconds = std::chrono::duration<float>(std::chrono::steady_clock::now() - start).count();
+    
+    std::cout << "Separate searches: " << separate_seconds << "s";
+    if (multi_seconds > 0) std::cout << " (" << separate_seconds / multi_seconds << "x)";
+    std::cout << std::endl;
+    std::cout << "Mismatched choices: " << mismatches << std::endl;
+}
+
+// screen-params depth min_prob param_sets_file positions_file [max_positions] [compare]
+//     param_sets_file holds up to 8 comma separated parameter sets, one per line
+//     positions_file is the output of `replay stream`
+int main(int argc, char *argv[]) {
+    assert ((argc >= 5) && (argc <= 7));
+    size_t max_positions = (argc >= 6) ? atoi(argv[5]) : SIZE_MAX;
+    bool compare = (argc == 7) && (std::string(argv[6]) == "compare");
+    
+    auto param_sets = read_param_sets(argv[3]);
+    auto positions = read_positions(argv[4], max_positions);
+    assert ((param_sets.size() > 0) && (param_sets.size() <= 8));
+    if (positions.empty()){
+        std::cerr << "No positions read from " << argv[4] << std::endl;
+        return 1;
+    }
+    
+    int depth = atoi(argv[1]);
+    float min_prob = atof(argv[2]);
+    
+    switch (param_sets.size()){
+        case 1: screen<1>(param_sets, positions, depth, min_prob, compare); break;
+        case 2: screen<2>(param_sets, positions, depth, min_prob, compare); break;
+        case 3: case 4: screen<4>(param_sets, positions, depth, min_prob, compare); break;
+        default: screen<8>(param_sets, positions, depth, min_prob, compare); break;
+    }
+    return 0;
+}
@@ -0,0 +1,125 @@
+#include "game.hpp"
+#include <algorithm>
+#include <random>
+
+// random board with values below n_values
+board_t random_board(std::mt19937_64& rng, const size_t& n_values){
+    board_t res = 0;
+    for (int i = 0; i < 16; ++i) res = (res << 4) | (rng() % n_values);
+    return res;
+}
+
+// compares every kernel of k against the generic kernels, returning the number of mismatches
+size_t check_kernels(const board_kernels& k, const std::vector<board_t>& boards, std::mt19937_64& rng){
+    const board_kernels& ref = kernels_for(ISA_GENERIC);
+    size_t mismatches = 0;
+    
+    for (auto b : boards){
+        board_t children[8], ref_children[8];
+        bool ok = (k.successors(b, children) == ref.successors(b, ref_children));
+        for (int d = 0; d < 8; ++d) ok = ok && (children[d] == ref_children[d]) && (children[d] == _shift_board(b, DIRECTIONS[d]));
+        ok = ok && (k.count_blanks(b) == ref.count_blanks(b));
+        
+        board_t v = b | 1;
+        u_int32_t r = 1 + rng() % popcount(v);
+        ok = ok && (k.select_bit(v, r) == ref.select_bit(v, r));
+        
+        u_int8_t perm[16];
+        for (int i = 0; i < 16; ++i) perm[i] = i;
+        std::shuffle(perm, perm + 16, rng);
+        ok = ok && (k.permute(b, perm) == ref.permute(b, perm)) && (k.permute(b, perm) == apply_permutation(b, perm));
+        
+        if (!ok){
+            if (mismatches < 10) std::cout << "Mismatch on 0x" << std::hex << b << std::dec << std::endl;
+            ++mismatches;
+        }
+    }
+    
+    // batched heuristic rows for every batch size used by multi_trans_table and the vector tails
+    std::uniform_real_distribution<float> dist(-1e6, 1e6);
+    for (size_t n = 1; n <= 40; ++n){
+        std::vector<std::vector<float>> in(8, std::vector<float>(n));
+        for (auto& x : in) for (auto& y : x) y = dist(rng);
+        std::vector<float> out(n), ref_out(n);
+        k.combine_rows(in[0].data(), in[1].data(), in[2].data(), in[3].data(), in[4].data(), in[5].data(), in[6].data(), in[7].data(), out.data(), n);
+        ref.combine_rows(in[0].data(), in[1].data(), in[2].data(), in[3].data(), in[4].data(), in[5].data(), in[6].data(), in[7].data(), ref_out.data(), n);
+        if (out != ref_out){
+            std::cout << "Mismatch in combine_rows for " << n << " sets" << std::endl;
+            ++mismatches;
+        }
+    }
+    
+    return mismatches;
+}
+
+// average time in ns of the successor generation of a board
+float time_successors(const board_kernels& k, const std::vector<board_t>& boards, board_t& checksum){
+    auto start = std::chrono::steady_clock::now();
+    board_t children[8];
+    for (auto b : boards){
+        checksum += k.successors(b, children);
+        for (int d = 0; d < 8; ++d) checksum ^= children[d];
+    }
+    return std::chrono::duration<float, std::nano>(std::chrono::steady_clock::now() - start).count() / boards.size();
+}
+
+// the same successors through the runtime direction switch: the valid move mask, then one shift per valid move
+float time_switch_loop(const std::vector<board_t>& boards, board_t& checksum){
+    auto start = std::chrono::steady_clock::now();
+    for (auto b : boards){
+        u_int16_t move_mask = _valid_move_mask(b);
+        checksum += move_mask;
+        for (int i = 0; move_mask; ++i, move_mask >>= 1){
+            if (move_mask & 1) checksum ^= _shift_board(b, DIRECTIONS[i]);
+        }
+    }
+    return std::chrono::duration<float, std::nano>(std::chrono::steady_clock::now() - start).count() / boards.size();
+}
+
+int main() {
+    std::mt19937_64 rng(2048);
+    std::vector<board_t> boards;
+    
+    for (size_t n_values = 2; n_values <= 16; ++n_values){
+        for (int i = 0; i < 100000; ++i) boards.push_back(random_board(rng, n_values));
+    }
+    
+    // boards reached in play
+    for (int game = 0; game < 4; ++game){
+        spawn_rng spawns(game);
+        Board B = generate_game(2);
+        while (!B.is_terminal()){
+            boards.push_back(B.board);
+            B.move(B.random_move(), spawns);
+        }
+    }
+    
+    std::cout << "Selected kernels: " << ISA_NAMES[KERNELS.isa] << std::endl;
+    std::cout << "Boards checked: " << boards.size() << std::endl;
+    
+    size_t mismatches = 0;
+    board_t checksum = 0;
+    
+    float switch_ns = time_switch_loop(boards, checksum);
+    switch_ns = time_switch_loop(boards, checksum);
+    std::cout << "switch loop: successors " << std::setprecision(4) << switch_ns << " ns" << std::endl;
+    
+    for (int isa = ISA_GENERIC; isa <= ISA_AVX512; ++isa){
+        if (!isa_supported((ISA_LEVEL) isa)){
+            std::cout << ISA_NAMES[isa] << ": not supported" << std::endl;
+            continue;
+        }
+        
+        const board_kernels& k = kernels_for((ISA_LEVEL) isa);
+        size_t m = check_kernels(k, boards, rng);
+        mismatches += m;
+        
+        // second pass is reported so every variant runs with warm tables
+        float ns = time_successors(k, boards, checksum);
+        ns = time_successors(k, boards, checksum);
+        std::cout << ISA_NAMES[isa] << ": " << m << " mismatches, successors " << std::setprecision(4) << ns << " ns" << std::endl;
+    }
+    
+    std::cout << "Checksum: " << std::hex << checksum << std::dec << std::endl;
+    return mismatches ? 1 : 0;
+}
@@ -0,0 +1,71 @@
+#include "game.hpp"
+#include "stats.hpp"
+#include <ctime>
+
+// cost and outcome of a batch of seeded transitions
+struct schedule_result {
+    u_int64_t n_moves = 0;
+    u_int64_t n_evals = 0;
+    size_t n_successes = 0;
+    running_moments score;
+    running_moments depth;
+    float cpu_seconds = 0;
+};
+
+// plays n_games seeded games from initial_pos until terminal_rank is reached, the game is lost or n_moves are played
+schedule_result play_transitions(trans_table& T, const depth_schedule& schedule, const float& min_prob, const board_t& initial_pos, const size_t& terminal_rank, const size_t& n_gens, const size_t& n_games, const size_t& n_moves){
+    schedule_result res;
+    std::clock_t start = std::clock();
+    u_int64_t evals_start = T.b_eval_count.load();
+    
+    for (size_t i = 0; i < n_games; ++i){
+        spawn_rng rng(i);
+        Board B = Board(initial_pos);
+        for (size_t j = 0; j < n_gens; ++j) B.generate_piece(rng);
+        
+        for (size_t j = 0; (j < n_moves) && !B.is_terminal() && (B.rank() < terminal_rank); ++j){
+            int depth = schedule.depth(B);
+            res.depth.add(depth);
+            B.move(T.expectimax(B, depth, min_prob), rng);
+            ++res.n_moves;
+        }
+        
+        res.n_successes += (B.rank() >= terminal_rank);
+        res.score.add(B.score());
+    }
+    
+    res.n_evals = T.b_eval_count.load() - evals_start;
+    res.cpu_seconds = (float) (std::clock() - start) / CLOCKS_PER_SEC;
+    return res;
+}
+
+void print_result(const std::string& name, const schedule_result& r){
+    std::cout << name << ": " << r.n_moves << " moves, mean depth " << r.depth.mean << ", " << r.n_evals << " evals, "
+    << r.cpu_seconds << "s cpu, " << r.n_successes << " successes, mean score " << r.score.mean << std::endl;
+}
+
+// compares a depth schedule against fixed depth 8 on the endgame transition studied in test-game-params
+int main(int argc, char *argv[]) {
+    assert (argc <= 5);
+    depth_schedule schedule = parse_depth_schedule((argc > 1) ? argv[1] : DEFAULT_DEPTH_SCHEDULE);
+    float min_prob = (argc > 2) ? atof(argv[2]) : 0.01;
+    size_t n_games = (argc > 3) ? atoi(argv[3]) : 4;
+    size_t n_moves = (argc > 4) ? atoi(argv[4]) : 200;
+    
+    const board_t initial_pos = 0xFECDBA89;
+    const size_t terminal_rank = 16;
+    const size_t n_gens = 6;
+    
+    std::unique_ptr<trans_table> T(new trans_table());
+    
+    schedule_result fixed = play_transitions(*T, depth_schedule(8), min_prob, initial_pos, terminal_rank, n_gens, n_games, n_moves);
+    print_result("Fixed depth 8", fixed);
+    
+    schedule_result scheduled = play_transitions(*T, schedule, min_prob, initial_pos, terminal_rank, n_gens, n_games, n_moves);
+    print_result("Schedule " + schedule.str(), scheduled);
+    
+    std::cout << "CPU saving: " << 100 * (1 - scheduled.cpu_seconds / fixed.cpu_seconds) << "% ("
+    << 100 * (1 - (float) scheduled.n_evals / fixed.n_evals) << "% of evals)" << std::endl;
+    
+    return 0;
+}
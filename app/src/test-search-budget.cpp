@@ -0,0 +1,85 @@
+#include "game.hpp"
+#include "search_budget.hpp"
+#include "stats.hpp"
+
+// cost of every move of a batch of seeded games
+struct move_costs {
+    running_moments evals;
+    quantile_sketch evals_sketch;
+    running_moments score;
+    float seconds = 0;
+};
+
+// plays n_games seeded games for n_moves each, choosing the settings of every search with choose(board)
+template <class F, class G>
+move_costs play_games(trans_table& T, const size_t& n_games, const size_t& n_moves, F choose, G record){
+    move_costs res;
+    auto start = std::chrono::steady_clock::now();
+    
+    for (size_t i = 0; i < n_games; ++i){
+        spawn_rng rng(i);
+        Board B = Board();
+        B.generate_piece(rng);
+        B.generate_piece(rng);
+        
+        for (size_t j = 0; (j < n_moves) && !B.is_terminal(); ++j){
+            search_params p = choose(B);
+            
+            auto search_start = std::chrono::steady_clock::now();
+            u_int64_t evals_start = T.b_eval_count.load();
+            DIRECTION best_move = T.expectimax(B, p.depth, p.min_prob);
+            u_int64_t n_evals = T.b_eval_count.load() - evals_start;
+            u_int64_t search_us = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - search_start).count();
+            
+            record(B, p, n_evals, search_us);
+            res.evals.add(n_evals);
+            res.evals_sketch.add(n_evals);
+            B.move(best_move, rng);
+        }
+        res.score.add(B.score());
+    }
+    
+    res.seconds = std::chrono::duration<float>(std::chrono::steady_clock::now() - start).count();
+    return res;
+}
+
+void print_costs(const std::string& name, const move_costs& c){
+    std::cout << name << ": " << c.evals.n << " moves in " << c.seconds << "s, evals/move mean " << c.evals.mean
+    << ", cv " << sqrt(c.evals.variance()) / c.evals.mean
+    << ", p10 " << c.evals_sketch.quantile(0.1) << ", p50 " << c.evals_sketch.quantile(0.5) << ", p90 " << c.evals_sketch.quantile(0.9)
+    << ", mean score " << c.score.mean << std::endl;
+}
+
+// compares a fixed depth and min_prob against the budget controller over the same seeded games
+int main(int argc, char *argv[]) {
+    assert ((argc == 6) | (argc == 7));
+    u_int64_t node_budget = atoll(argv[1]);
+    int fixed_depth = atoi(argv[2]);
+    float fixed_min_prob = atof(argv[3]);
+    size_t n_games = atoi(argv[4]);
+    size_t n_moves = atoi(argv[5]);
+    int max_depth = (argc == 7) ? atoi(argv[6]) : fixed_depth;
+    
+    trans_table T;
+    
+    move_costs fixed = play_games(T, n_games, n_moves,
+        [&](const Board&){return search_params{fixed_depth, fixed_min_prob};},
+        [](const Board&, const search_params&, u_int64_t, u_int64_t){});
+    print_costs("Fixed", fixed);
+    
+    budget_controller budget(node_budget, max_depth);
+    running_moments depths;
+    running_moments log_min_probs;
+    move_costs adaptive = play_games(T, n_games, n_moves,
+        [&](const Board& B){
+            search_params p = budget.next(B);
+            depths.add(p.depth);
+            log_min_probs.add(log10(p.min_prob));
+            return p;
+        },
+        [&](const Board& B, const search_params& p, u_int64_t n_evals, u_int64_t search_us){budget.record(B, p, n_evals, search_us);});
+    print_costs("Budget", adaptive);
+    std::cout << "Budget settings: mean depth " << depths.mean << ", mean log10(min_prob) " << log_min_probs.mean << std::endl;
+    
+    return 0;
+}
@@ -0,0 +1,105 @@
+#include "game.hpp"
+#include "stats.hpp"
+#include <ctime>
+
+// cost and outcome of a batch of seeded transitions
+struct sampling_result {
+    u_int64_t n_moves = 0;
+    u_int64_t n_evals = 0;
+    size_t n_successes = 0;
+    running_moments score;
+    float cpu_seconds = 0;
+};
+
+// plays n_games seeded games from initial_pos until terminal_rank is reached, the game is lost or n_moves are played
+sampling_result play_transitions(trans_table& T, const int& depth, const float& min_prob, const board_t& initial_pos, const size_t& terminal_rank, const size_t& n_gens, const size_t& n_games, const size_t& n_moves){
+    sampling_result res;
+    std::clock_t start = std::clock();
+    u_int64_t evals_start = T.b_eval_count.load();
+    
+    for (size_t i = 0; i < n_games; ++i){
+        spawn_rng rng(i);
+        Board B = Board(initial_pos);
+        for (size_t j = 0; j < n_gens; ++j) B.generate_piece(rng);
+        
+        for (size_t j = 0; (j < n_moves) && !B.is_terminal() && (B.rank() < terminal_rank); ++j){
+            B.move(T.expectimax(B, depth, min_prob), rng);
+            ++res.n_moves;
+        }
+        
+        res.n_successes += (B.rank() >= terminal_rank);
+        res.score.add(B.score());
+    }
+    
+    res.n_evals = T.b_eval_count.load() - evals_start;
+    res.cpu_seconds = (float) (std::clock() - start) / CLOCKS_PER_SEC;
+    return res;
+}
+
+void print_result(const std::string& name, const sampling_result& r){
+    std::cout << name << ": " << r.n_moves << " moves, " << r.n_evals << " evals, " << r.cpu_seconds << "s cpu, "
+    << r.n_successes << " successes, mean score " << r.score.mean << ", " << 60 * r.n_successes / r.cpu_seconds << " successes per cpu minute" << std::endl;
+}
+
+// positions of a seeded game played at depth 2, every fifth one
+std::vector<board_t> open_positions(trans_table& T, const size_t& n_positions){
+    std::vector<board_t> positions;
+    spawn_rng rng(2048);
+    Board B = Board();
+    B.generate_piece(rng);
+    B.generate_piece(rng);
+    
+    for (size_t i = 0; (positions.size() < n_positions) && !B.is_terminal(); ++i){
+        if (i % 5 == 0) positions.push_back(B.board);
+        B.move(T.expectimax(B, 2, 0), rng);
+    }
+    return positions;
+}
+
+// compares stratified spawn sampling against exact expectimax, on single positions and on played transitions
+int main(int argc, char *argv[]) {
+    assert (argc <= 6);
+    int depth = (argc > 1) ? atoi(argv[1]) : 6;
+    size_t n_samples = (argc > 2) ? atoi(argv[2]) : 4;
+    float min_prob = (argc > 3) ? atof(argv[3]) : 0.01;
+    size_t n_games = (argc > 4) ? atoi(argv[4]) : 4;
+    size_t n_moves = (argc > 5) ? atoi(argv[5]) : 1000;
+    
+    std::unique_ptr<trans_table> T(new trans_table());
+    
+    // move agreement on the positions of one game
+    std::vector<board_t> positions = open_positions(*T, 100);
+    size_t n_agree = 0;
+    u_int64_t evals[2] = {};
+    float seconds[2] = {};
+    for (auto p : positions){
+        DIRECTION moves[2];
+        for (int sampled = 0; sampled < 2; ++sampled){
+            T->spawn_samples = sampled ? n_samples : 0;
+            u_int64_t evals_start = T->b_eval_count.load();
+            std::clock_t start = std::clock();
+            moves[sampled] = T->expectimax(Board(p), depth, min_prob);
+            seconds[sampled] += (float) (std::clock() - start) / CLOCKS_PER_SEC;
+            evals[sampled] += T->b_eval_count.load() - evals_start;
+        }
+        n_agree += (moves[0] == moves[1]);
+    }
+    std::cout << positions.size() << " positions at depth " << depth << ", min_prob " << min_prob << std::endl;
+    std::cout << "Exact: " << evals[0] << " evals in " << seconds[0] << "s cpu" << std::endl;
+    std::cout << n_samples << " samples: " << evals[1] << " evals in " << seconds[1] << "s cpu, " << n_agree << " moves agree" << std::endl;
+    
+    // game strength on an open midgame transition, from 8192 to 16384
+    const board_t initial_pos = 0xDCBA;
+    const size_t terminal_rank = 14;
+    const size_t n_gens = 2;
+    
+    T->spawn_samples = 0;
+    print_result("Exact depth " + std::to_string(depth), play_transitions(*T, depth, min_prob, initial_pos, terminal_rank, n_gens, n_games, n_moves));
+    
+    T->spawn_samples = n_samples;
+    for (int d = depth; d <= depth + 1; ++d){
+        print_result(std::to_string(n_samples) + " samples depth " + std::to_string(d), play_transitions(*T, d, min_prob, initial_pos, terminal_rank, n_gens, n_games, n_moves));
+    }
+    
+    return 0;
+}
@@ -0,0 +1,99 @@
+#include "game.hpp"
+#include <random>
+
+// random board with values below n_values, small alphabets give many symmetric boards
+board_t random_board(std::mt19937_64& rng, const size_t& n_values){
+    board_t res = 0;
+    for (int i = 0; i < 16; ++i) res = (res << 4) | (rng() % n_values);
+    return res;
+}
+
+// checks that moves commute with every symmetry and that stabilizer finds every symmetry fixing a board
+size_t check_group(const std::vector<board_t>& boards){
+    const symmetry_group& group = symmetries();
+    size_t mismatches = 0;
+    
+    for (auto b : boards){
+        size_t n_fixing = 0;
+        for (size_t g = 0; g < N_SYMMETRIES; ++g){
+            board_t image = apply_symmetry(b, g);
+            n_fixing += (image == b);
+            for (size_t d = 0; d < 8; ++d){
+                if (_shift_board(image, DIRECTIONS[group.move_image[g][d]]) != apply_symmetry(_shift_board(b, DIRECTIONS[d]), g)) ++mismatches;
+            }
+        }
+        
+        u_int16_t elements[SYMMETRY_MAX_CANDIDATES + 1];
+        size_t n = stabilizer(b, elements);
+        if ((n != 1) && (n != n_fixing)) ++mismatches;
+    }
+    return mismatches;
+}
+
+// searches every position with and without collapsing symmetric moves and spawns
+void compare_searches(const std::vector<board_t>& positions, const int& depth, const float& min_prob){
+    std::unique_ptr<trans_table> T(new trans_table());
+    size_t n_symmetric = 0;
+    size_t n_agree = 0;
+    u_int64_t evals[2] = {};
+    float seconds[2] = {};
+    
+    for (auto p : positions){
+        DIRECTION reps[8];
+        bool symmetric = collapse_moves(p, reps);
+        n_symmetric += symmetric;
+        
+        DIRECTION moves[2];
+        for (int collapse = 0; collapse < 2; ++collapse){
+            T->collapse_symmetries = collapse;
+            u_int64_t evals_start = T->b_eval_count.load();
+            auto start = std::chrono::steady_clock::now();
+            moves[collapse] = T->expectimax(Board(p), depth, min_prob);
+            seconds[collapse] += std::chrono::duration<float>(std::chrono::steady_clock::now() - start).count();
+            evals[collapse] += T->b_eval_count.load() - evals_start;
+        }
+        
+        // equivalent moves score the same, so either is a correct choice
+        n_agree += symmetric ? (reps[moves[0]] == reps[moves[1]]) : (moves[0] == moves[1]);
+    }
+    
+    std::cout << positions.size() << " positions (" << n_symmetric << " with symmetric root moves) at depth " << depth << ", min_prob " << min_prob << std::endl;
+    std::cout << "Exact: " << evals[0] << " evals in " << seconds[0] << "s" << std::endl;
+    std::cout << "Collapsed: " << evals[1] << " evals in " << seconds[1] << "s, " << n_agree << " moves agree up to symmetry" << std::endl;
+}
+
+int main(int argc, char *argv[]) {
+    assert (argc <= 3);
+    int depth = (argc > 1) ? atoi(argv[1]) : 6;
+    float min_prob = (argc > 2) ? atof(argv[2]) : 0.001;
+    
+    std::mt19937_64 rng(2048);
+    std::vector<board_t> boards;
+    for (size_t n_values = 2; n_values <= 6; ++n_values){
+        for (int i = 0; i < 2000; ++i) boards.push_back(random_board(rng, n_values));
+    }
+    
+    // boards with a mirror symmetry
+    for (int i = 0; i < 2000; ++i){
+        board_t half = random_board(rng, 8) & 0x0000'0000'ffff'ffff;
+        boards.push_back(half | flip(half, 3));
+    }
+    
+    std::cout << "Boards checked: " << boards.size() << std::endl;
+    std::cout << "Mismatches: " << check_group(boards) << std::endl;
+    
+    // structured endgames: symmetric arrangements of large tiles with a few small tiles spawned on them
+    std::vector<board_t> positions;
+    const std::vector<board_t> endgames = {0xFEEF000000000000, 0xFEDC000000000000 | flip(0xFEDC, 3), 0xEDDE0000DCCD0000, 0xFE00000000000000};
+    for (size_t i = 0; i < endgames.size(); ++i){
+        for (u_int64_t seed = 0; seed < 8; ++seed){
+            spawn_rng spawns(seed);
+            Board B = Board(endgames[i]);
+            if (seed) B.generate_piece(spawns);
+            if (!B.is_terminal()) positions.push_back(B.board);
+        }
+    }
+    compare_searches(positions, depth, min_prob);
+    
+    return 0;
+}
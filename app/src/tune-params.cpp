@@ -0,0 +1,27 @@
+#include "tuner.hpp"
+
+const std::vector<float> initial_params = {
+    50.0f, //merge weight
+    300.0f, //blank weight
+    20.0f, //cubic face weight
+    5.0f, //square face weight relative to cube
+    3.0f,  //edge weight relative to square
+    2.0f,  //monotone curl weight
+};
+
+// the transitions studied in test-game-params
+const std::vector<tuning_scenario> scenarios = {
+    {0xFECD, 16, 4},
+    {0xEDBC, 15, 4},
+    {0xDCAB, 14, 4},
+};
+
+// tune-params depth min_prob n_games n_generations checkpoint_file log_file [population]
+int main(int argc, char *argv[]) {
+    assert ((argc == 7) | (argc == 8));
+    size_t population = (argc == 8) ? atoi(argv[7]) : 0;
+    
+    std::vector<float> params = tune_params(initial_params, scenarios, atoi(argv[1]), atof(argv[2]), atoi(argv[3]), atoi(argv[4]), argv[5], argv[6], population);
+    std::cout << "Best Params: " << params << std::endl;
+    return 0;
+}
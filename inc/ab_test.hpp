@@ -0,0 +1,33 @@
+#pragma once
+#include "game.hpp"
+
+enum AB_METRIC {
+    SUCCESS_RATE, // proportion of games reaching terminal_rank
+    MEAN_SCORE // mean final score
+};
+
+// sequential probability ratio test that parameter set B improves on parameter set A
+struct sprt_config {
+    AB_METRIC metric = SUCCESS_RATE;
+    float alpha = 0.05; // probability of accepting B when it is no better
+    float beta = 0.05; // probability of rejecting B when it is better by effect
+    float effect = 0.1; // SUCCESS_RATE: P(B wins a discordant pair) - 0.5, MEAN_SCORE: relative score gain
+    size_t min_pairs = 10; // pairs played before the score test may stop
+    size_t max_pairs = 1000;
+};
+
+struct sprt_state {
+    size_t n_pairs = 0;
+    size_t a_only = 0; // pairs where only A succeeded
+    size_t b_only = 0; // pairs where only B succeeded
+    double sum_a = 0;
+    double sum_diff = 0;
+    double sum_sq_diff = 0;
+    double llr = 0;
+    int decision = 0; // 1 accept B, -1 reject B, 0 undecided
+    
+    void update(const sprt_config& config, const Board& A, const Board& B, const size_t& terminal_rank);
+};
+
+// plays games in pairs on common spawn sequences until the test stops
+sprt_state ab_test(const sprt_config& config, int depth, float min_prob, const std::vector<float>& params_a, const std::vector<float>& params_b, board_t initial_pos=0, size_t terminal_rank=17, size_t n_gens=2, u_int64_t seed=0, bool verbose=true);
@@ -0,0 +1,33 @@
+#pragma once
+#include "board.hpp"
+#include "trans_table.hpp"
+#include "game_record.hpp"
+#include "thread_pool.hpp"
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <set>
+#include <string>
+
+// result of re-searching one recorded position
+struct position_analysis {
+    u_int64_t seed; // seed of the game's record
+    size_t game; // index of the game in its record file
+    u_int32_t ply;
+    board_t board;
+    DIRECTION played;
+    DIRECTION best;
+    float played_val;
+    float best_val;
+    bool blunder;
+};
+
+// evaluates every valid move of a position and compares the played move against the best
+position_analysis analyse_position(trans_table& T, const board_t& board, const DIRECTION& played, const int& depth, const float& min_prob, const float& blunder_threshold);
+
+// re-searches every position of the recorded games in parallel, appending results to output_path;
+// positions already present in output_path are skipped so interrupted runs can be resumed.
+// positions are identified by record seed, game index within its file and ply, so files can be reordered, added or dropped between runs
+void analyse_records(const std::vector<std::string>& record_paths, const std::string& output_path, int depth, float min_prob, float blunder_threshold, size_t n_threads);
+
+std::ostream& operator<<(std::ostream& os, const position_analysis& a);
@@ -10,6 +10,9 @@
 #include <stdio.h>
 #include <unordered_map>
 #include <vector>
+#ifdef __SSSE3__
+#include <immintrin.h>
+#endif
 
 typedef u_int64_t board_t;
 
@@ -25,6 +28,7 @@ enum DIRECTION {
 };
 
 extern const DIRECTION DIRECTIONS[8];
+extern const char* DIRECTION_NAMES[8];
 extern const board_t ROW_MASK;
 extern const board_t COL_MASK;
 extern const board_t CUBE_MASK;
@@ -42,7 +46,9 @@ extern const std::array<float, 65536> row_mon_vals;
 extern const std::array<float, 65536> row_pow_val;
 extern const std::array<float, 65536> row_edge_val;
 extern const std::array<int, 65536> n_row_merges;
+extern const std::array<int, 65536> row_zero_count;
 extern const std::array<bool, 65536> row_is_terminal;
+extern const std::array<u_int8_t, 65536> row_max_key;
 
 extern const float MONOTONICITY_BASE;
 extern const float BOARD_VALUE_BASE;
@@ -50,6 +56,7 @@ extern const int LOSS_PENALTY;
 
 int popcount(const u_int64_t& x);
 int _popcount(u_int64_t x);
+u_int64_t selectBit(u_int64_t v, u_int32_t r);
 
 // board metadata related functions
 board_t arr_to_row_transition(std::vector<board_t> arr);
@@ -64,6 +71,7 @@ bool is_terminal_row(std::vector<board_t> arr);
 float row_merge_score(std::vector<board_t> arr);
 float row_mon_value(std::vector<board_t> arr);
 float edge_pow_value(std::vector<board_t> arr);
+u_int8_t row_max_key_value(std::vector<board_t> arr);
 int loc_val(const board_t& val);
 float loc_pow_val(float val);
 
@@ -188,6 +196,28 @@ constexpr size_t _count(const board_t& board, const size_t& rank) {
     return res;
 }
 
+// value of the nibble at location loc, where location 0 is the most significant nibble
+constexpr size_t nibble_at(const board_t& board, const size_t& loc){
+    return (board >> (60 - 4 * loc)) & 0xf;
+}
+
+// moves nibble perm[i] of the board to nibble i (nibbles indexed from the least significant)
+inline board_t apply_permutation(const board_t& board, const u_int8_t* perm){
+#ifdef __SSSE3__
+    // spreads nibbles into bytes, shuffles with pshufb and packs back into nibbles
+    const __m128i low_nibbles = _mm_set1_epi8(0x0f);
+    __m128i v = _mm_cvtsi64_si128((long long) board);
+    __m128i nibbles = _mm_unpacklo_epi8(_mm_and_si128(v, low_nibbles), _mm_and_si128(_mm_srli_epi16(v, 4), low_nibbles));
+    __m128i shuffled = _mm_shuffle_epi8(nibbles, _mm_loadu_si128((const __m128i*) perm));
+    __m128i pairs = _mm_and_si128(_mm_or_si128(shuffled, _mm_srli_epi16(shuffled, 4)), _mm_set1_epi16(0x00ff));
+    return (board_t) _mm_cvtsi128_si64(_mm_packus_epi16(pairs, pairs));
+#else
+    board_t res = 0;
+    for (int i = 0; i < 16; ++i) res |= ((board >> (4 * perm[i])) & 0xf) << (4 * i);
+    return res;
+#endif
+}
+
 // move based methods
 constexpr board_t move_l(const board_t& board){
     board_t board0 = l_move_table[ROW_MASK & board];
@@ -276,6 +306,37 @@ constexpr board_t _shift_board(const board_t& board, const DIRECTION& d) {
     }
 }
 
+// move tables by direction, L to RR act on rows and U to DD on columns gathered by col_to_row
+constexpr const std::array<board_t, 65536>* MOVE_TABLES[8] = {
+    &l_move_table, &ll_move_table, &r_move_table, &rr_move_table,
+    &u_move_table, &uu_move_table, &d_move_table, &dd_move_table
+};
+
+// shifts the four row (L to RR) or column (U to DD) indices of a board, with the table chosen at compile time
+template <DIRECTION d>
+inline board_t shift_lines(const board_t* lines){
+    const std::array<board_t, 65536>& t = *MOVE_TABLES[d];
+    const int step = (d < U) ? 16 : 4;
+    return t[lines[0]] | (t[lines[1]] << step) | (t[lines[2]] << (2 * step)) | (t[lines[3]] << (3 * step));
+}
+
+// all 8 successors of a board with the direction loop unrolled, returns the valid move mask
+inline u_int16_t unrolled_successors(const board_t& board, const board_t* rows, const board_t* cols, board_t* children){
+    children[L] = shift_lines<L>(rows);
+    children[LL] = shift_lines<LL>(rows);
+    children[R] = shift_lines<R>(rows);
+    children[RR] = shift_lines<RR>(rows);
+    children[U] = shift_lines<U>(cols);
+    children[UU] = shift_lines<UU>(cols);
+    children[D] = shift_lines<D>(cols);
+    children[DD] = shift_lines<DD>(cols);
+    
+    return (children[L] != board) | ((children[LL] != board) << 1)
+    | ((children[R] != board) << 2) | ((children[RR] != board) << 3)
+    | ((children[U] != board) << 4) | ((children[UU] != board) << 5)
+    | ((children[D] != board) << 6) | ((children[DD] != board) << 7);
+}
+
 constexpr u_int16_t _valid_move_mask(const board_t& board) {
     u_int16_t res = 0;
     for (int d = 0; d < 8; ++d){
@@ -284,6 +345,22 @@ constexpr u_int16_t _valid_move_mask(const board_t& board) {
     return res;
 }
 
+// valid moves in direction order, held inline so the game loop does not allocate
+struct move_list {
+    DIRECTION moves[8];
+    size_t n = 0;
+    
+    move_list(u_int16_t move_mask){
+        for (; move_mask; move_mask &= move_mask - 1) moves[n++] = (DIRECTION) __builtin_ctz(move_mask);
+    };
+    
+    size_t size() const {return n;};
+    bool empty() const {return n == 0;};
+    const DIRECTION& operator[](const size_t& i) const {return moves[i];};
+    const DIRECTION* begin() const {return moves;};
+    const DIRECTION* end() const {return moves + n;};
+};
+
 constexpr bool rows_are_terminal(const board_t& board){
     return row_is_terminal[ROW_MASK & board] &&
     row_is_terminal[ROW_MASK & (board >> 16)] &&
@@ -295,6 +372,15 @@ constexpr bool _is_terminal(const board_t& board){
     return rows_are_terminal(board) && rows_are_terminal(transpose(board));
 }
 
+// chained merges available along the rows and along the columns, low counts mark boards close to locking up
+constexpr int merge_potential(const board_t& board){
+    board_t cols = transpose(board);
+    return n_row_merges[ROW_MASK & board] + n_row_merges[ROW_MASK & (board >> 16)]
+    + n_row_merges[ROW_MASK & (board >> 32)] + n_row_merges[ROW_MASK & (board >> 48)]
+    + n_row_merges[ROW_MASK & cols] + n_row_merges[ROW_MASK & (cols >> 16)]
+    + n_row_merges[ROW_MASK & (cols >> 32)] + n_row_merges[ROW_MASK & (cols >> 48)];
+}
+
 // finds blank tiles
 constexpr board_t is_blank(const board_t& board){
     board_t blanks = ~board;
@@ -313,10 +399,25 @@ constexpr int board_score(const board_t& board){
 
 size_t _get(const board_t& board, const size_t& x0, const size_t& x1, const size_t& x2, const size_t& x3);
 board_t _set(const board_t& board, const size_t& x0, const size_t& x1, const size_t& x2, const size_t& x3, size_t val);
-std::vector<DIRECTION> _valid_moves(const board_t& board);
+move_list _valid_moves(const board_t& board);
+
+// counter based random source, paired games with the same seed see the same draws at every ply
+class spawn_rng {
+private:
+    u_int64_t seed;
+    u_int64_t counter = 0;
+    
+public:
+    spawn_rng(const u_int64_t& seed) : seed(seed) {};
+    u_int32_t next();
+};
 
 // encapsulation of 2048-4d board
 class Board {
+private:
+    board_t spawn_piece(const u_int32_t& tile_draw, const u_int32_t& value_draw);
+    void check_max_tile(const int& correction);
+    
 public:
     board_t board = 0;
     int penalty = 0;
@@ -333,10 +434,14 @@ public:
     
     // move based methods
     board_t shift_board(const DIRECTION& d);
-    std::vector<DIRECTION> valid_moves() const;
+    move_list valid_moves() const;
     u_int16_t valid_move_mask() const;
     board_t generate_piece();
+    board_t generate_piece(spawn_rng& rng);
+    board_t place_piece(const size_t& loc, const size_t& val);
     board_t move(const DIRECTION& d);
+    board_t move(const DIRECTION& d, spawn_rng& rng);
+    board_t move(const DIRECTION& d, const size_t& spawn_loc, const size_t& spawn_val);
     DIRECTION random_move() const;
 };
 
@@ -0,0 +1,38 @@
+#pragma once
+#include "board.hpp"
+
+enum ISA_LEVEL {
+    ISA_GENERIC, // baseline x86-64
+    ISA_BMI2, // PEXT/PDEP and pshufb
+    ISA_AVX2, // 256-bit batched heuristic rows
+    ISA_AVX512 // 512-bit batched heuristic rows
+};
+
+extern const char* ISA_NAMES[4];
+
+// hot kernels compiled once per instruction set, selected at startup
+struct board_kernels {
+    ISA_LEVEL isa;
+    
+    // writes the board shifted in each of the 8 directions to children and returns the valid move mask
+    u_int16_t (*successors)(const board_t& board, board_t* children);
+    
+    // number of blank tiles, popcount of is_blank
+    int (*count_blanks)(const board_t& board);
+    
+    // 63 - index of the set bit of v with rank r counted from the most significant bit, as selectBit
+    u_int64_t (*select_bit)(u_int64_t v, u_int32_t r);
+    
+    // apply_permutation
+    board_t (*permute)(const board_t& board, const u_int8_t* perm);
+    
+    // out[i] = top[i] + second[i] + max(a0[i] + a1[i], b0[i] + b1[i], c0[i] + c1[i]) over k parameter sets
+    void (*combine_rows)(const float* top, const float* second, const float* a0, const float* a1, const float* b0, const float* b1, const float* c0, const float* c1, float* out, const size_t& k);
+};
+
+// best level supported by this cpu, capped by the BOARD_ISA environment variable (generic, bmi2, avx2, avx512)
+ISA_LEVEL detect_isa();
+bool isa_supported(const ISA_LEVEL& isa);
+const board_kernels& kernels_for(const ISA_LEVEL& isa);
+
+extern const board_kernels KERNELS;
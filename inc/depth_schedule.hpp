@@ -0,0 +1,39 @@
+#pragma once
+#include "board.hpp"
+#include <string>
+#include <vector>
+
+extern const char* DEFAULT_DEPTH_SCHEDULE;
+
+// search depth for boards matching every condition of the rule
+struct depth_rule {
+    int depth;
+    size_t min_rank = 0;
+    int max_empty = 16;
+    int max_merges = 64; // merge_potential at most this
+    
+    bool matches(const Board& board) const;
+};
+
+// search depth picked per move from board features, the first matching rule wins.
+// written as rules separated by ';', each a depth and optional conditions, e.g. "8:rank>=14,empty<=4;6:empty<=8;4".
+// a plain number is a fixed depth, and a rule without conditions matches every board and must come last
+class depth_schedule {
+private:
+    std::vector<depth_rule> rules;
+    int fallback;
+    std::string spec;
+    
+public:
+    depth_schedule(const int& depth);
+    
+    // throws std::invalid_argument if spec is malformed
+    depth_schedule(const std::string& spec);
+    
+    int depth(const Board& board) const;
+    int max_depth() const;
+    const std::string& str() const {return spec;};
+};
+
+// parses a schedule given on the command line, printing the error and exiting if it is malformed
+depth_schedule parse_depth_schedule(const std::string& spec);
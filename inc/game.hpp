@@ -1,6 +1,11 @@
 #pragma once
 #include "board.hpp"
+#include "depth_schedule.hpp"
 #include "trans_table.hpp"
+#include "game_record.hpp"
+#include "interleaved_search.hpp"
+#include "ponder.hpp"
+#include "search_budget.hpp"
 #include <stdio.h>
 #include <chrono>
 #include <queue>
@@ -8,10 +13,13 @@
 #include <fstream>
 #include <sstream>
 
-void display_ai_game(int depth, float min_prob, bool show_analytics=true);
+void display_ai_game(const depth_schedule& schedule, float min_prob, bool show_analytics=true, bool ponder=false);
 void display_mcts_game(int n_sims, bool show_analytics);
-void test_params(int depth, float min_prob, size_t n_sims, std::stringstream& filepath);
-float test_transition(int depth, float min_prob, board_t initial_pos, size_t terminal_rank, std::vector<float> params, size_t n_gens, size_t n_games, bool verbose=false);
+void display_record(const game_record& record, int frame_ms, bool show_analytics=true);
+void test_params(const depth_schedule& schedule, float min_prob, size_t n_sims, std::stringstream& filepath, size_t n_interleaved=1);
+void test_budget(budget_controller budget, const std::string& budget_str, size_t n_sims, std::stringstream& filepath);
+Board play_seeded_game(trans_table& T, int depth, float min_prob, board_t initial_pos, size_t terminal_rank, size_t n_gens, u_int64_t seed);
+float test_transition(const depth_schedule& schedule, float min_prob, board_t initial_pos, size_t terminal_rank, std::vector<float> params, size_t n_gens, size_t n_games, bool verbose=false);
 void test_transition_random_params(int depth, float min_prob, board_t initial_pos, size_t terminal_rank, size_t n_gens, size_t n_games, size_t n_sims);
 
 std::ostream& operator<<(std::ostream& os, const std::vector<float>& v);
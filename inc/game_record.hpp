@@ -0,0 +1,139 @@
+#pragma once
+#include "board.hpp"
+#include <array>
+#include <fstream>
+#include <istream>
+#include <mutex>
+#include <string>
+#include <vector>
+
+extern const u_int32_t RECORD_MAGIC;
+extern const u_int16_t RECORD_VERSION;
+extern const u_int16_t RECORD_HAS_STATS;
+extern const size_t RECORD_N_PARAMS;
+extern const size_t RECORD_HEADER_SIZE;
+extern const u_int8_t NO_SPAWN;
+
+// fixed size header written at the start of every game record
+struct record_header {
+    u_int16_t flags = 0;
+    u_int64_t seed = 0;
+    std::array<float, 6> params = {};
+    int32_t depth = 0; // search depth, the deepest rule of the schedule if the depth was scheduled
+    float min_prob = 0;
+    board_t initial_board = 0;
+    int32_t final_score = 0;
+    u_int32_t n_plies = 0;
+};
+
+// a single ply; boards are rederived from the move and the spawned tile
+struct ply_record {
+    u_int8_t move;
+    u_int8_t spawn_loc; // nibble index of the spawned tile, NO_SPAWN if none
+    u_int8_t spawn_val; // log2 of the spawned tile
+};
+
+// optional per-ply search statistics
+struct ply_stats {
+    u_int32_t n_evals; // board evaluations used to pick the move
+    u_int32_t search_us; // wall time of the search in microseconds
+};
+
+// record of one game, built in memory as the game is played
+class game_record {
+public:
+    record_header header;
+    std::vector<ply_record> plies;
+    std::vector<ply_stats> stats;
+
+    game_record() {};
+    game_record(const u_int64_t& seed, const std::vector<float>& params, const int& depth, const float& min_prob, const board_t& initial_board, bool with_stats=false);
+
+    bool has_stats() const;
+    void add_ply(const DIRECTION& move, const board_t& shifted, const board_t& spawned);
+    void add_ply(const DIRECTION& move, const board_t& shifted, const board_t& spawned, const ply_stats& s);
+    void finish(const Board& B);
+
+    // binary encoding, little-endian
+    void serialize(std::string& buf) const;
+    size_t serialized_size() const;
+};
+
+// appends complete records to a file, safe to share between concurrent games
+class record_writer {
+private:
+    std::ofstream file;
+    std::mutex file_lock;
+
+public:
+    record_writer(const std::string& filepath);
+    void append(const game_record& record);
+    void flush();
+};
+
+// reads records back one at a time from a stream of appended records
+class record_reader {
+private:
+    std::istream& in;
+    std::string buf;
+
+public:
+    record_reader(std::istream& in) : in(in) {};
+    bool next(game_record& record);
+};
+
+// outcome of replaying a record against the board rules
+struct replay_result {
+    Board board; // position after the last ply
+    u_int32_t n_plies = 0; // plies replayed, up to the first illegal one
+    int score = 0;
+    size_t rank = 0;
+    bool legal = true; // every move changed the board and every spawn was a 2 or 4 on an empty tile
+    bool score_matches = true; // recomputed score equals the recorded final score
+    bool ended_terminal = false;
+};
+
+// true if the ply is a move that changes the board followed by a 2 or 4 spawned on an empty tile
+inline bool is_legal_ply(const board_t& board, const ply_record& p){
+    if (p.move > DD) return false;
+    
+    board_t shifted = _shift_board(board, (DIRECTION) p.move);
+    if (shifted == board) return false;
+    if (p.spawn_loc == NO_SPAWN) return true;
+    
+    return (p.spawn_loc <= 15) && ((p.spawn_val == 1) || (p.spawn_val == 2)) && !((shifted >> (4 * p.spawn_loc)) & 0xf);
+}
+
+// rebuilds every position of a record, calling f(board before move, ply index, ply).
+// replay stops before the first illegal ply, which f never sees
+template <class F>
+replay_result replay_record(const game_record& record, F f){
+    replay_result res;
+    Board B = Board(record.header.initial_board);
+    
+    // initial tiles are part of the starting board and count towards the score
+    for (board_t tmp = B.board; tmp; tmp >>= 4) if (tmp & 0xf) B.penalty += 1 << (tmp & 0xf);
+    
+    for (u_int32_t i = 0; i < record.plies.size(); ++i){
+        const ply_record& p = record.plies[i];
+        if (!is_legal_ply(B.board, p)){
+            res.legal = false;
+            break;
+        }
+        f(B, i, p);
+        
+        if (p.spawn_loc == NO_SPAWN){
+            B.shift_board((DIRECTION) p.move);
+        } else {
+            B.move((DIRECTION) p.move, p.spawn_loc, p.spawn_val);
+        }
+        ++res.n_plies;
+    }
+    
+    res.board = B;
+    res.score = B.score();
+    res.rank = B.rank();
+    res.score_matches = (res.score == record.header.final_score);
+    res.ended_terminal = B.is_terminal();
+    return res;
+}
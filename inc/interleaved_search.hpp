@@ -0,0 +1,94 @@
+#pragma once
+#include "board.hpp"
+#include "search_arena.hpp"
+#include "trans_cache.hpp"
+#include "trans_table.hpp"
+#include <memory>
+#include <vector>
+
+extern const int INTERLEAVE_MIN_DEPTH;
+
+// one node of an explicit expectimax stack, either a move node or an expectation node
+struct search_frame {
+    board_t board;
+    board_t children[8]; // successors of a move node
+    board_t free_tiles; // tiles of an expectation node still to be spawned on
+    board_t tile_bit; // lowest bit of the tile currently spawned on
+    float prob;
+    float factor;
+    float res;
+    int depth;
+    int n_empty_tiles;
+    u_int16_t move_mask; // successors of a move node not yet searched
+    u_int8_t is_move_node;
+    u_int8_t phase;
+    u_int8_t weighted; // free_tiles holds one spawn per orbit or stratum, weighted by weights
+    u_int8_t weights[16];
+};
+
+// expectimax of one position as a resumable state machine, equivalent to trans_table::expectimax.
+// step() runs until the search is about to probe its cache at depth INTERLEAVE_MIN_DEPTH or more,
+// prefetches the bucket and returns, so that the caller can advance other searches while the line is fetched
+class search_machine {
+private:
+    trans_table& T;
+    search_arena arena;
+    trans_cache cache;
+    std::vector<search_frame> stack; // one move and one expectation node per level of depth
+    size_t top;
+    float ret; // value of the last node popped
+
+    board_t root;
+    int depth;
+    float min_prob;
+    move_list moves;
+    size_t move_idx;
+    float move_scores[8];
+    DIRECTION reps[8]; // lowest equivalent root move, when symmetric_root
+    bool symmetric_root;
+    DIRECTION best;
+    bool done;
+
+    void push_move_node(const board_t& board, const int& depth, const float& prob);
+    void push_expectation_node(const board_t& board, const int& depth, const float& prob);
+    void start_root_move();
+    void finish_root_move();
+
+public:
+    u_int64_t n_evals = 0;
+
+    search_machine(trans_table& T);
+
+    void start(const Board& board, const int& depth, const float& min_prob);
+
+    // advances the search to its next cache probe, returns true once the search has finished
+    bool step();
+    bool finished() const {return done;};
+    DIRECTION result() const {return best;};
+    
+    // the root moves whose value is final so far, in the order of root_moves()
+    const move_list& root_moves() const {return moves;};
+    size_t n_moves_searched() const {return move_idx;};
+    float move_score(const size_t& i) const {return move_scores[i];};
+};
+
+// multiplexes up to width searches on the calling thread, switching to the next search at every cache probe
+// so that one core keeps several memory requests in flight. meant for batch runs of independent games
+class interleaved_search {
+private:
+    std::vector<std::unique_ptr<search_machine>> slots;
+    std::vector<bool> running;
+    size_t n_running = 0;
+    size_t cursor = 0;
+
+public:
+    interleaved_search(trans_table& T, const size_t& width);
+
+    size_t width() const {return slots.size();};
+
+    // starts searching board in an idle slot
+    void start(const size_t& slot, const Board& board, const int& depth, const float& min_prob);
+
+    // runs the searches until one finishes, returning false if none are running
+    bool next_result(size_t& slot, DIRECTION& move, u_int64_t& n_evals);
+};
@@ -0,0 +1,53 @@
+#pragma once
+#include "board.hpp"
+#include <atomic>
+#include <memory>
+
+extern const size_t LEAF_CACHE_LOG2;
+
+// memoized heuristic value of one leaf board
+struct leaf_entry {
+    board_t board;
+    float value;
+    u_int32_t generation; // parameter generation of the table that computed the value, 0 if empty
+};
+
+// direct-mapped cache of leaf heuristic values, one per thread so that lookups need no synchronisation.
+// entries are tagged with a parameter generation, so tables with different parameters share it without mixing values
+class leaf_cache {
+private:
+    std::unique_ptr<leaf_entry[]> entries;
+    size_t shift;
+    
+    leaf_entry& entry(const board_t& board) const {
+        return entries[(board * 0x9E3779B97F4A7C15ULL) >> shift];
+    };
+    
+public:
+    u_int64_t n_lookups = 0;
+    u_int64_t n_hits = 0;
+    
+    leaf_cache(const size_t& log2 = LEAF_CACHE_LOG2);
+    
+    bool find(const board_t& board, const u_int32_t& generation, float& value){
+        ++n_lookups;
+        const leaf_entry& e = entry(board);
+        if ((e.board != board) || (e.generation != generation)) return false;
+        ++n_hits;
+        value = e.value;
+        return true;
+    };
+    
+    void insert(const board_t& board, const u_int32_t& generation, const float& value){
+        entry(board) = {board, value, generation};
+    };
+    
+    // adds the counts since the last flush to the given totals, whichever tables made the lookups
+    void flush_stats(std::atomic<u_int64_t>& lookups, std::atomic<u_int64_t>& hits);
+};
+
+// the leaf cache of the calling thread
+leaf_cache& thread_leaf_cache();
+
+// a generation not handed out before, for a new set of heuristic parameters
+u_int32_t next_leaf_generation();
@@ -0,0 +1,49 @@
+#pragma once
+#include "trans_table.hpp"
+
+// pre-combined heuristic rows for K parameter sets, with the K values of each row stored contiguously
+template <size_t K>
+struct multi_row {
+    float top[K];
+    float second[K];
+    float partial[K];
+};
+
+template <size_t K>
+struct multi_emax_state {
+    std::array<float, K> val;
+    float min_prob;
+    int depth;
+};
+
+template <size_t K>
+using multi_cached_emax_states_t = robin_hood::unordered_flat_map<board_t, multi_emax_state<K>>;
+
+// expectimax that scores every leaf against K parameter sets in the same tree walk;
+// move generation and chance node expansion are shared, values are tracked per set
+template <size_t K>
+class multi_trans_table {
+private:
+    std::vector<multi_row<K>> rows;
+    
+    // one cache per root move, cleared rather than rebuilt between searches so their buckets are reused
+    multi_cached_emax_states_t<K> root_caches[8];
+    
+public:
+    std::atomic<u_int64_t> b_eval_count;
+    batch_pool root_workers; // searches the root moves in parallel, as in trans_table
+    bool prove_losses = false; // as trans_table::prove_losses
+    multi_trans_table(const std::vector<std::vector<float>>& param_sets);
+    
+    // heuristic based methods
+    std::array<float, K> non_terminal_heuristic(const board_t& board) const;
+    std::array<float, K> heuristic(const board_t& board) const;
+    
+    // expectimax methods
+    std::array<float, K> move_node(const board_t& board, const int& depth, const float& prob, multi_cached_emax_states_t<K>& cached_emax_values, const float& min_prob = 1e-6);
+    std::array<float, K> expectation_node(const board_t& board, const int& depth, const float& prob, multi_cached_emax_states_t<K>& cached_emax_values, const float& min_prob = 1e-6);
+    std::array<float, K> entry_node(const board_t& board, const int& depth, const float& min_prob = 1e-6);
+    
+    // best move for each parameter set; the root caches are shared, so one search per table at a time
+    std::array<DIRECTION, K> expectimax(const Board& board, const int& depth, const float& min_prob = 1e-6);
+};
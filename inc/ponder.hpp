@@ -0,0 +1,59 @@
+#pragma once
+#include "board.hpp"
+#include "depth_schedule.hpp"
+#include "interleaved_search.hpp"
+#include "trans_table.hpp"
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+extern const size_t PONDER_MAX_POSITIONS;
+
+// searches the spawn outcomes of the last move on a background thread while the game commits it.
+// every outcome gets its root move values computed as the next expectimax would, most likely spawns first,
+// so that once the real spawn is known the next search only covers the root moves pondering did not reach
+class ponderer {
+private:
+    trans_table& T;
+    search_machine machine;
+    std::thread worker;
+    
+    std::mutex lock;
+    std::condition_variable job_ready;
+    std::condition_variable job_done;
+    bool has_job = false;
+    bool busy = false;
+    bool stopping = false;
+    std::atomic<bool> stop_requested;
+    
+    board_t afterstate;
+    const depth_schedule* schedule;
+    float min_prob;
+    
+    // results of the last job, only read or written while no job is running
+    std::vector<root_scores> results;
+    size_t n_results = 0;
+    
+    void run();
+    void ponder();
+    
+public:
+    ponderer(trans_table& T);
+    ~ponderer();
+    
+    // starts searching the outcomes of the board a move left before its spawn, each at the depth schedule gives it.
+    // schedule must outlive the search
+    void start(const board_t& afterstate, const depth_schedule& schedule, const float& min_prob);
+    
+    // stops the background search, keeping every root move value it finished
+    void stop();
+    
+    // stops pondering and picks a move as trans_table::expectimax would, reusing pondered root moves
+    DIRECTION expectimax(const Board& board, const int& depth, const float& min_prob);
+    
+    // number of root moves answered from pondering since construction
+    u_int64_t n_hits = 0;
+    u_int64_t n_root_moves = 0;
+};
@@ -0,0 +1,16 @@
+#pragma once
+#include "board.hpp"
+#include "cpu_dispatch.hpp"
+
+extern const int PROOF_DEPTH;
+extern const int PROOF_MAX_EMPTY;
+extern const size_t PROOF_CACHE_SIZE;
+
+// cheap filter for chance nodes worth trying to prove lost: crowded boards only
+inline bool near_terminal(const int& n_empty_tiles){
+    return n_empty_tiles <= PROOF_MAX_EMPTY;
+}
+
+// true if the chance node board (a board after a move, before the spawn) loses within k moves under every spawn.
+// proofs do not depend on the heuristic, so they are cached per thread across searches
+bool proven_lost(const board_t& board, const int& k);
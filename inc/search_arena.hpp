@@ -0,0 +1,56 @@
+#pragma once
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <sys/types.h>
+#include <vector>
+
+extern const size_t SEARCH_ARENA_BYTES;
+
+// bump allocator for storage that lives for one search, reset in O(1) between searches.
+// memory is reserved once with mmap (transparent huge pages where available) and only committed when touched
+class search_arena {
+private:
+    char* base;
+    size_t capacity;
+    size_t offset;
+    size_t high_water;
+    u_int8_t gen;
+    
+public:
+    search_arena(const size_t& capacity = SEARCH_ARENA_BYTES);
+    ~search_arena();
+    search_arena(const search_arena&) = delete;
+    search_arena& operator=(const search_arena&) = delete;
+    
+    // nullptr if the arena is exhausted
+    void* allocate(const size_t& n_bytes, const size_t& alignment = 64);
+    
+    // frees everything and starts a new generation; memory is only wiped when the generation wraps around,
+    // so users tag their data with generation() to tell it apart from earlier searches
+    void reset();
+    u_int8_t generation() const {return gen;};
+    size_t bytes_used() const {return offset;};
+};
+
+class arena_pool;
+
+// returns an arena to its pool instead of freeing it
+struct arena_return {
+    arena_pool* pool;
+    void operator()(search_arena* arena) const;
+};
+
+typedef std::unique_ptr<search_arena, arena_return> arena_ptr;
+
+// arenas kept between searches, one per concurrent search
+class arena_pool {
+private:
+    std::mutex lock;
+    std::vector<std::unique_ptr<search_arena>> idle;
+    
+public:
+    // a reset arena, reused if one is idle
+    arena_ptr acquire();
+    void release(search_arena* arena);
+};
@@ -0,0 +1,42 @@
+#pragma once
+#include "board.hpp"
+
+extern const float BUDGET_MIN_PROB_FLOOR;
+extern const float BUDGET_MIN_PROB_CEIL;
+extern const float BUDGET_LEARNING_RATE;
+
+// search settings for one move
+struct search_params {
+    int depth;
+    float min_prob;
+};
+
+// picks min_prob and depth per move so that each search costs roughly a fixed number of board evaluations,
+// or a fixed time with the evaluation rate measured from previous moves.
+// tree size is modelled per empty tile count as log(evals) = scale + slope * log(1 / min_prob); the slope is fixed from
+// measurements and the scale is corrected after every move from the evaluations it actually took
+class budget_controller {
+private:
+    u_int64_t node_budget;
+    u_int64_t time_budget_us; // 0 for a node budget
+    int max_depth;
+    float log_scale[17];
+    float evals_per_us;
+    
+    float slope(const int& n_empty) const;
+    
+public:
+    budget_controller(const u_int64_t& node_budget, const int& max_depth = 8);
+    
+    // targets time_budget_us microseconds per move instead
+    static budget_controller for_time(const u_int64_t& time_budget_us, const int& max_depth = 8);
+    
+    u_int64_t current_node_budget() const;
+    int get_max_depth() const {return max_depth;};
+    float predicted_evals(const board_t& board, const search_params& p) const;
+    
+    search_params next(const Board& board) const;
+    
+    // updates the model with the cost of the search of board
+    void record(const Board& board, const search_params& p, const u_int64_t& n_evals, const u_int64_t& search_us);
+};
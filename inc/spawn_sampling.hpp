@@ -0,0 +1,10 @@
+#pragma once
+#include "board.hpp"
+
+extern const int SAMPLE_MIN_DEPTH;
+
+// splits the empty cells of a chance node into n_samples strata of consecutive cells and keeps one cell of each,
+// picked by a hash of the board so that a board always gets the same sample and its cached value stays consistent.
+// free_tiles keeps the sampled cells and weights[cell] the size of their stratum.
+// returns false, leaving the arguments untouched, when there are no more empty cells than samples
+bool sample_spawns(const board_t& board, const size_t& n_samples, board_t& free_tiles, u_int8_t* weights);
@@ -0,0 +1,71 @@
+#pragma once
+#include "board.hpp"
+#include "game_record.hpp"
+#include <iostream>
+#include <fstream>
+#include <map>
+#include <string>
+
+extern const float SKETCH_ACCURACY;
+extern const float CONFIDENCE_Z;
+
+// relative-error quantile sketch over log-spaced buckets; merging sums bucket counts exactly
+class quantile_sketch {
+private:
+    float gamma;
+    float log_gamma;
+    u_int64_t zero_count = 0;
+    std::map<int, u_int64_t> buckets;
+    
+public:
+    u_int64_t n = 0;
+    
+    quantile_sketch(const float& accuracy=SKETCH_ACCURACY);
+    void add(const float& x);
+    void merge(const quantile_sketch& other);
+    float value_at_rank(const float& rank) const;
+    float quantile(const float& q) const;
+    
+    // confidence interval of the q quantile from the binomial distribution of its rank
+    std::pair<float, float> quantile_interval(const float& q, const float& z=CONFIDENCE_Z) const;
+    
+    void save(std::ostream& os) const;
+    void load(std::istream& is);
+};
+
+// count, mean and variance, mergeable with Chan's update
+struct running_moments {
+    u_int64_t n = 0;
+    double mean = 0;
+    double m2 = 0;
+    
+    void add(const double& x);
+    void merge(const running_moments& other);
+    double variance() const;
+    std::pair<double, double> mean_interval(const float& z=CONFIDENCE_Z) const;
+};
+
+// Wilson score interval of a proportion
+std::pair<float, float> proportion_interval(const u_int64_t& successes, const u_int64_t& n, const float& z=CONFIDENCE_Z);
+
+// aggregate statistics of many game results, mergeable between shards
+class result_stats {
+public:
+    u_int64_t n_games = 0;
+    u_int64_t rank_counts[17] = {};
+    running_moments score_moments;
+    quantile_sketch scores;
+    running_moments plies;
+    quantile_sketch moves_per_second;
+    
+    void add_game(const int& score, const size_t& rank);
+    void add_record(const game_record& record);
+    void merge(const result_stats& other);
+    
+    // streams results from `{score=..., rank=...}` text files, binary records or saved shards
+    void add_file(const std::string& path);
+    
+    void save(std::ostream& os) const;
+    void load(std::istream& is);
+    void report(std::ostream& os) const;
+};
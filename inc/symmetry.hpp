@@ -0,0 +1,37 @@
+#pragma once
+#include "board.hpp"
+#include "cpu_dispatch.hpp"
+
+extern const size_t N_SYMMETRIES;
+extern const int SYMMETRY_MIN_DEPTH;
+extern const size_t SYMMETRY_MAX_CANDIDATES;
+
+// the 384 symmetries of the 2x2x2x2 board (axis flips and axis permutations) as nibble permutations,
+// with the cell each location is sent to and the direction each move is sent to
+struct symmetry_group {
+    alignas(16) u_int8_t perms[384][16]; // nibble i of the image is nibble perms[g][i] of the board
+    u_int8_t cell_image[384][16];
+    u_int8_t move_image[384][8];
+    u_int16_t sending[16][16][24]; // the symmetries sending location a to location b
+    
+    symmetry_group();
+};
+
+// built on first use, since the direction images need the move tables of board.cpp
+const symmetry_group& symmetries();
+
+inline board_t apply_symmetry(const board_t& board, const size_t& g){
+    return KERNELS.permute(board, symmetries().perms[g]);
+}
+
+// symmetries fixing the board, the identity included, found among those that permute the cells of its rarest value.
+// boards whose rarest value covers too many cells report the identity only, which is always safe
+size_t stabilizer(const board_t& board, u_int16_t* elements);
+
+// groups the empty cells of a chance node into orbits under the board's stabilizer.
+// free_tiles keeps one representative per orbit and weights[cell] counts the cells it stands for.
+// returns false, leaving the arguments untouched, when the stabilizer is trivial
+bool collapse_spawns(const board_t& board, board_t& free_tiles, u_int8_t* weights);
+
+// for every direction, the lowest direction reaching an equivalent board; returns false when no two moves are equivalent
+bool collapse_moves(const board_t& board, DIRECTION* reps);
@@ -0,0 +1,80 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// fixed set of workers, each with its own task queue; idle workers steal from the others
+class work_stealing_pool {
+private:
+    struct worker_queue {
+        std::mutex lock;
+        std::deque<std::function<void()>> tasks;
+    };
+    
+    std::vector<std::unique_ptr<worker_queue>> queues;
+    std::vector<std::thread> workers;
+    std::atomic<size_t> n_queued;
+    std::atomic<size_t> n_pending;
+    std::atomic<size_t> next_queue;
+    bool stopping = false;
+    std::mutex state_lock;
+    std::condition_variable work_available;
+    std::condition_variable work_done;
+    
+    bool try_pop(const size_t& idx, std::function<void()>& task);
+    bool try_steal(const size_t& idx, std::function<void()>& task);
+    void run(const size_t& idx);
+    
+public:
+    work_stealing_pool(size_t n_threads=std::thread::hardware_concurrency());
+    ~work_stealing_pool();
+    
+    size_t size() const;
+    
+    // tasks submitted with the same hint land in the same queue and tend to run on the same worker
+    void submit(std::function<void()> task);
+    void submit(std::function<void()> task, const size_t& hint);
+    
+    // blocks until every submitted task has finished
+    void wait();
+};
+
+// persistent workers that run one batch of indexed calls at a time, without allocating per batch.
+// workers are started by the first batch; a batch submitted while another is running runs inline on the caller
+class batch_pool {
+private:
+    size_t n_threads;
+    std::vector<std::thread> workers;
+    std::mutex batch_lock; // held by the caller for the whole batch
+    std::mutex state_lock;
+    std::condition_variable batch_ready;
+    std::condition_variable batch_done;
+    
+    void (*fn)(void*, size_t) = nullptr;
+    void* ctx = nullptr;
+    size_t n_tasks = 0;
+    std::atomic<size_t> next_task;
+    size_t n_done = 0;
+    size_t n_active = 0; // workers that have taken a snapshot of the current batch
+    size_t batch_id = 0;
+    bool stopping = false;
+    
+    void worker_loop(size_t seen_batch);
+    void work(void (*f)(void*, size_t), void* c, const size_t& n);
+    void run_batch(const size_t& n, void (*f)(void*, size_t), void* c);
+    
+public:
+    batch_pool(size_t n_threads);
+    ~batch_pool();
+    
+    // calls f(i) for i in [0, n) across the workers and the calling thread, returning when all calls are done
+    template <class F>
+    void run(const size_t& n, F& f){
+        run_batch(n, [](void* c, size_t i){(*(F*) c)(i);}, &f);
+    };
+};
@@ -0,0 +1,60 @@
+#pragma once
+#include "board.hpp"
+#include "search_arena.hpp"
+
+extern const size_t TRANS_CACHE_MIN_LOG2;
+extern const size_t TRANS_CACHE_MAX_LOG2;
+extern const size_t TRANS_CACHE_WAYS;
+
+// packed 16 byte entry; the key is stored xor'd with the data word, so a torn or foreign entry fails verification
+struct cache_entry {
+    u_int64_t check; // board ^ data
+    u_int64_t data; // value bits (0-31), quantized min_prob (32-47), depth (48-55), age (56-63)
+};
+
+// four entries sharing one cache line
+struct cache_bucket {
+    cache_entry entries[4];
+};
+
+// rounds min_prob up to the upper 16 bits of its float encoding, monotone for positive values
+u_int16_t quantize_prob(const float& p);
+
+// set-associative transposition table for expectation nodes, carved from a search arena.
+// doubles while half full up to 2^max_log2 buckets (or until the arena is full) and replaces the shallowest entry of a bucket after that.
+// a value answers any query at the same or lower remaining depth and the same or larger min_prob
+class trans_cache {
+private:
+    search_arena& arena;
+    cache_bucket* buckets;
+    size_t shift;
+    size_t min_log2;
+    size_t max_log2;
+    size_t limit_log2; // max_log2 as requested, before any cap from a full arena
+    size_t n_entries;
+    u_int8_t age; // generation of the arena, entries of earlier searches read as empty
+    
+    cache_bucket* allocate(const size_t& buckets_log2);
+    void grow();
+    void place(const board_t& board, const u_int64_t& data);
+    
+    cache_bucket& bucket(const board_t& board) const {
+        return buckets[(board * 0x9E3779B97F4A7C15ULL) >> shift];
+    };
+    
+public:
+    trans_cache(search_arena& arena, const size_t& buckets_log2 = TRANS_CACHE_MIN_LOG2, const size_t& max_log2 = TRANS_CACHE_MAX_LOG2);
+    
+    bool find(const board_t& board, const int& depth, const float& min_prob, float& val) const;
+    void insert(const board_t& board, const int& depth, const float& min_prob, const float& val);
+    
+    // resets the arena and starts over from the initial size, forgetting every entry
+    void reset();
+    
+    // pulls the bucket of a board into cache ahead of its lookup
+    void prefetch(const board_t& board) const {
+        __builtin_prefetch(&bucket(board));
+    };
+
+    size_t size_bytes() const;
+};
@@ -1,8 +1,18 @@
 # pragma once
 # include "board.hpp"
+# include "cpu_dispatch.hpp"
+# include "leaf_cache.hpp"
+# include "proof_cache.hpp"
+# include "spawn_sampling.hpp"
+# include "symmetry.hpp"
+# include "thread_pool.hpp"
+# include "trans_cache.hpp"
 # include <future>
 # include <atomic>
 # include <robin_hood.h>
+# ifdef __F16C__
+# include <immintrin.h>
+# endif
 
 extern const size_t MAX_DEPTH;
 extern const bool MULTITHREADED;
@@ -13,33 +23,96 @@ T max4(const T& x0, const T& x1, const T& x2, const T& x3);
 template <class T>
 T max6(const T& x0, const T& x1, const T& x2, const T& x3, const T& x4, const T& x5);
 
-struct emax_state {
-    float val;
-    float min_prob;
+typedef trans_cache cached_emax_states_t;
+
+// root move values of a position searched ahead of time, indexed by direction
+struct root_scores {
+    board_t board = 0;
+    int depth = 0;
+    float min_prob = 0;
+    u_int16_t known_mask = 0;
+    float scores[8];
+    
+    bool matches(const board_t& board, const int& depth, const float& min_prob) const {
+        return (this->board == board) && (this->depth == depth) && (this->min_prob == min_prob);
+    };
 };
 
-struct move_state {
-    DIRECTION move;
-    float emax_val;
+#ifdef HEURISTIC_FLOAT16
+// scaled half precision table values, halving the tables to 512KB
+typedef u_int16_t heuristic_val_t;
+#else
+typedef float heuristic_val_t;
+#endif
+
+// pre-combined heuristic values of one row, so that a leaf reads a single entry per row
+struct heuristic_row {
+    heuristic_val_t top; // weighted square value less curl penalty, for the leading square (bits 48-63)
+    heuristic_val_t second; // square value less curl penalty, for the second square (bits 32-47)
+    heuristic_val_t partial; // merge and blank value, for the secondary cube heuristic
+    heuristic_val_t pad;
 };
 
-typedef std::vector<robin_hood::unordered_flat_map<board_t, emax_state>> cached_emax_states_t;
+u_int16_t float_to_half(const float& f);
+float _half_to_float(const u_int16_t& h);
+
+inline float half_to_float(const u_int16_t& h){
+#ifdef __F16C__
+    return _cvtsh_ss(h);
+#else
+    return _half_to_float(h);
+#endif
+}
 
 // board manipulation methods used only for calculating heuristics
 board_t reorganize(const board_t& board, const size_t& level=0);
 
+// reorganize(board, 0) as one table lookup of the composed symmetry and a single nibble permutation
+board_t fast_reorganize(const board_t& board);
+
 // transposition table used for 2048-4d-ai
 class trans_table {
 private:
     std::vector<float> params;
-    float _partial_square_row[65536];
-    float _aug_partial_square_row[65536];
-    float _partial_heuristic[65536];
-    float _aug_row_mon_vals[65536];
+    u_int32_t leaf_generation; // tags leaf cache entries computed with the current params
+    alignas(16) heuristic_row _rows[65536];
+    
+#ifdef HEURISTIC_FLOAT16
+    float _top_scale;
+    float _second_scale;
+    float _partial_scale;
+    
+    float top_val(const board_t& row) const {return _top_scale * half_to_float(_rows[row].top);};
+    float second_val(const board_t& row) const {return _second_scale * half_to_float(_rows[row].second);};
+    float partial_val(const board_t& row) const {return _partial_scale * half_to_float(_rows[row].partial);};
+#else
+    float top_val(const board_t& row) const {return _rows[row].top;};
+    float second_val(const board_t& row) const {return _rows[row].second;};
+    float partial_val(const board_t& row) const {return _rows[row].partial;};
+#endif
     
 public:
     std::atomic<u_int64_t> b_eval_count;
-    trans_table(const std::vector<float>& params={800,600,20,15,5,0});
+    arena_pool arenas; // search storage reused between moves, one arena per concurrent search
+    batch_pool root_workers; // searches the root moves in parallel
+    bool prove_losses = false; // scores crowded chance nodes proven lost under every spawn without expanding them
+    bool collapse_symmetries = false; // searches one of each set of equivalent root moves and spawns
+    size_t spawn_samples = 0; // if set, chance nodes with more empty tiles search this many stratified samples instead
+    bool cache_leaves = true; // memoizes leaf heuristics in a per thread leaf_cache
+    
+    // leaf cache lookups and hits, flushed from the calling thread's counters after each search.
+    // the counters are per thread, not per table, so lookups of another table searched on the same thread
+    // since its last flush are credited to this one; tables searched on separate threads count exactly
+    std::atomic<u_int64_t> leaf_lookups;
+    std::atomic<u_int64_t> leaf_hits;
+    
+    // n_root_workers threads search the root moves, 0 for one per core up to 8.
+    // tables searched from threads of an outer pool should use 1 so the pools do not oversubscribe the cores
+    trans_table(const std::vector<float>& params={800,600,20,15,5,0}, const size_t& n_root_workers=0);
+    
+    // rebuilds the weighted tables from the parameter independent row features
+    void set_params(const std::vector<float>& params);
+    const std::vector<float>& get_params() const;
     
     // heuristic based ethods
     float non_terminal_heuristic(const board_t& board) const;
@@ -47,12 +120,18 @@ public:
     float secondary_cube_heuristic(const board_t& board) const;
     float heuristic(const board_t& board) const;
     
+    // non_terminal_heuristic, through the leaf cache of the calling thread if cache_leaves is set
+    float leaf_heuristic(const board_t& board) const;
+    
     // expectimax methods
     float move_node(const board_t& board, const int& depth, const float& prob, cached_emax_states_t& cached_emax_values,  const float& min_prob = 1e-6);
     float expectation_node(const board_t& board, const int& depth, const float& prob, cached_emax_states_t& cached_emax_values,  const float& min_prob = 1e-6);
     float entry_node(const board_t& board, const int& depth, const float& prob, const float& min_prob = 1e-6);
     DIRECTION expectimax(const Board& board, const int& depth, const float& min_prob = 1e-6);
     
+    // as above, taking the value of every root move in known instead of searching it, if known is for this search
+    DIRECTION expectimax(const Board& board, const int& depth, const float& min_prob, const root_scores* known);
+    
     // monte carlo tree search
     long long mcts_score(const Board& board, const DIRECTION& move, const size_t& n_sims);
     DIRECTION mcts(const Board& board, const size_t& n_sims);
@@ -0,0 +1,52 @@
+#pragma once
+#include "game.hpp"
+#include "thread_pool.hpp"
+#include <random>
+#include <string>
+
+// a start position used to score parameter sets, as in test_transition
+struct tuning_scenario {
+    board_t initial_pos;
+    size_t terminal_rank;
+    size_t n_gens;
+};
+
+// covariance matrix adaptation evolution strategy, minimising over log-parameters
+class cma_es {
+private:
+    size_t n;
+    size_t mu;
+    std::vector<double> weights;
+    double mu_eff, c_sigma, d_sigma, c_c, c_1, c_mu, chi_n;
+    std::vector<double> eigen_vals;
+    std::vector<std::vector<double>> eigen_vecs;
+    std::mt19937_64 rng;
+    
+    void set_strategy_params();
+    void update_eigensystem();
+    
+public:
+    size_t lambda;
+    size_t generation = 0;
+    double sigma;
+    std::vector<double> mean;
+    std::vector<std::vector<double>> cov;
+    std::vector<double> p_sigma;
+    std::vector<double> p_c;
+    std::vector<double> best_x;
+    double best_f = INFINITY;
+    
+    cma_es(const std::vector<double>& mean, const double& sigma, size_t lambda=0, u_int64_t seed=0);
+    
+    std::vector<std::vector<double>> ask();
+    void tell(const std::vector<std::vector<double>>& xs, const std::vector<double>& fs);
+    
+    void save(std::ostream& os) const;
+    bool load(std::istream& is);
+};
+
+// mean success rate of a parameter set over the scenarios, with seeded spawns shared by all candidates
+float evaluate_params(trans_table& T, const std::vector<float>& params, const std::vector<tuning_scenario>& scenarios, int depth, float min_prob, size_t n_games, u_int64_t seed);
+
+// tunes the trans_table weights; resumes from checkpoint_path if it exists and appends every evaluation to log_path
+std::vector<float> tune_params(const std::vector<float>& initial_params, const std::vector<tuning_scenario>& scenarios, int depth, float min_prob, size_t n_games, size_t n_generations, const std::string& checkpoint_path, const std::string& log_path, size_t population=0);
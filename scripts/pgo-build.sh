@@ -0,0 +1,68 @@
+#!/bin/sh
+# builds the release binaries with profile guided optimisation and reports the gain over a plain release build.
+#
+# usage: scripts/pgo-build.sh [train_scale] [extra cmake arguments...]
+#
+# 1. plain release build, timed on pgo-train as the baseline
+# 2. instrumented build, pgo-train writes the profiles to pgo-profiles/
+# 3. the same build tree rebuilt with the profiles, timed on pgo-train again
+#
+# the optimised binaries are left in bin/.
+set -e
+
+cd "$(dirname "$0")/.."
+ROOT=$(pwd)
+SCALE=${1:-2}
+[ $# -gt 0 ] && shift
+
+PROFILES="$ROOT/pgo-profiles"
+BASE_BUILD="$ROOT/build-pgo-base"
+PGO_BUILD="$ROOT/build-pgo"
+RESULTS=$(mktemp -d)
+JOBS=$(nproc 2>/dev/null || echo 1)
+
+# binaries of every build are written to bin/, so each stage keeps its own copy of the driver
+echo "== baseline build"
+cmake -S . -B "$BASE_BUILD" -DPGO_MODE= "$@" > /dev/null
+cmake --build "$BASE_BUILD" -j"$JOBS" --target pgo-train > /dev/null
+cp bin/pgo-train "$RESULTS/pgo-train-base"
+
+echo "== instrumented build"
+rm -rf "$PROFILES"
+cmake -S . -B "$PGO_BUILD" -DPGO_MODE=GENERATE -DPGO_DIR="$PROFILES" "$@" > /dev/null
+cmake --build "$PGO_BUILD" -j"$JOBS" > /dev/null
+
+echo "== training (scale $SCALE)"
+bin/pgo-train "$SCALE"
+if command -v llvm-profdata > /dev/null && ls "$PROFILES"/*.profraw > /dev/null 2>&1; then
+    llvm-profdata merge -output="$PROFILES/default.profdata" "$PROFILES"/*.profraw
+fi
+
+# same build tree, so gcc finds the profiles under the object paths it recorded
+echo "== optimised build"
+cmake -S . -B "$PGO_BUILD" -DPGO_MODE=USE -DPGO_DIR="$PROFILES" "$@" > /dev/null
+cmake --build "$PGO_BUILD" -j"$JOBS" --clean-first > /dev/null
+cp bin/pgo-train "$RESULTS/pgo-train-pgo"
+
+# the timing runs use the same seeds as training, alternating builds to spread out machine noise
+echo "== timing"
+for i in 1 2 3; do
+    "$RESULTS/pgo-train-base" "$SCALE" > "$RESULTS/base.out"
+    "$RESULTS/pgo-train-pgo" "$SCALE" > "$RESULTS/pgo.out"
+    grep Total "$RESULTS/base.out" | awk '{print $2}' | tr -d s >> "$RESULTS/base.txt"
+    grep Total "$RESULTS/pgo.out" | awk '{print $2}' | tr -d s >> "$RESULTS/pgo.txt"
+done
+
+# both builds must play the same expectimax games
+if [ "$(grep Expectimax "$RESULTS/base.out" | awk '{print $NF}')" != "$(grep Expectimax "$RESULTS/pgo.out" | awk '{print $NF}')" ]; then
+    echo "Expectimax games differ between the builds"
+    exit 1
+fi
+
+BASE=$(sort -n "$RESULTS/base.txt" | head -1)
+PGO=$(sort -n "$RESULTS/pgo.txt" | head -1)
+echo "Baseline: ${BASE}s (best of 3)"
+echo "PGO: ${PGO}s (best of 3)"
+awk -v b="$BASE" -v p="$PGO" 'BEGIN {printf "Speedup: %.3fx\n", b / p}'
+
+rm -rf "$RESULTS"
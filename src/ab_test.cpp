@@ -0,0 +1,64 @@
+#include "ab_test.hpp"
+
+void sprt_state::update(const sprt_config& config, const Board& A, const Board& B, const size_t& terminal_rank){
+    ++n_pairs;
+    double upper = log((1 - config.beta) / config.alpha);
+    double lower = log(config.beta / (1 - config.alpha));
+    
+    if (config.metric == SUCCESS_RATE){
+        
+        // only discordant pairs carry information about which parameter set is better
+        bool a_success = A.rank() >= terminal_rank;
+        bool b_success = B.rank() >= terminal_rank;
+        double p1 = 0.5 + config.effect;
+        
+        if (b_success && !a_success){
+            ++b_only;
+            llr += log(p1 / 0.5);
+        } else if (a_success && !b_success){
+            ++a_only;
+            llr += log((1 - p1) / 0.5);
+        }
+        
+    } else {
+        
+        // Gaussian test on the paired score differences with the variance estimated from the sample
+        double diff = B.score() - A.score();
+        sum_a += A.score();
+        sum_diff += diff;
+        sum_sq_diff += diff * diff;
+        
+        if (n_pairs < std::max(config.min_pairs, (size_t) 2)) return;
+        double delta = config.effect * sum_a / n_pairs;
+        double variance = (sum_sq_diff - sum_diff * sum_diff / n_pairs) / (n_pairs - 1);
+        if (variance <= 0) return;
+        llr = (delta * sum_diff - n_pairs * delta * delta / 2) / variance;
+    }
+    
+    if (llr >= upper) decision = 1;
+    else if (llr <= lower) decision = -1;
+}
+
+sprt_state ab_test(const sprt_config& config, int depth, float min_prob, const std::vector<float>& params_a, const std::vector<float>& params_b, board_t initial_pos, size_t terminal_rank, size_t n_gens, u_int64_t seed, bool verbose){
+    if (seed == 0) seed = time(NULL);
+    trans_table TA(params_a);
+    trans_table TB(params_b);
+    sprt_state state;
+    
+    while ((state.decision == 0) && (state.n_pairs < config.max_pairs)){
+        u_int64_t game_seed = seed + state.n_pairs;
+        
+        Board A = play_seeded_game(TA, depth, min_prob, initial_pos, terminal_rank, n_gens, game_seed);
+        Board B = play_seeded_game(TB, depth, min_prob, initial_pos, terminal_rank, n_gens, game_seed);
+        state.update(config, A, B, terminal_rank);
+        
+        if (verbose){
+            std::cout << "{pair=" << state.n_pairs << ", seed=" << game_seed;
+            std::cout << ", score_a=" << A.score() << ", score_b=" << B.score();
+            std::cout << ", rank_a=" << (1 << A.rank()) << ", rank_b=" << (1 << B.rank());
+            std::cout << ", llr=" << std::setprecision(4) << state.llr << "}" << std::endl;
+        }
+    }
+    
+    return state;
+}
@@ -0,0 +1,129 @@
+#include "analysis.hpp"
+#include <cinttypes>
+#include <tuple>
+
+position_analysis analyse_position(trans_table& T, const board_t& board, const DIRECTION& played, const int& depth, const float& min_prob, const float& blunder_threshold){
+    position_analysis res = {0, 0, 0, board, played, played, -INFINITY, -INFINITY, false};
+    
+    // shares one cache across the root moves, as in single threaded expectimax
+    arena_ptr arena = T.arenas.acquire();
+    cached_emax_states_t cached_emax_values(*arena);
+    
+    for (auto move : _valid_moves(board)){
+        float val = T.expectation_node(_shift_board(board, move), depth, 1.0, cached_emax_values, min_prob);
+        
+        if (move == played) res.played_val = val;
+        if (val > res.best_val){
+            res.best_val = val;
+            res.best = move;
+        }
+    }
+    
+    // loss is measured relative to the magnitude of the best value
+    res.blunder = (res.best_val - res.played_val) > blunder_threshold * std::abs(res.best_val);
+    return res;
+}
+
+// a position of a recorded game, independent of the order of the record files
+struct position_key {
+    u_int64_t seed;
+    size_t game;
+    u_int32_t ply;
+    
+    bool operator<(const position_key& other) const {
+        return std::tie(seed, game, ply) < std::tie(other.seed, other.game, other.ply);
+    };
+};
+
+// reads the positions analysed by a previous run
+std::set<position_key> read_checkpoint(const std::string& output_path){
+    std::set<position_key> done;
+    std::ifstream in(output_path);
+    std::string line;
+    position_key key;
+    
+    while (std::getline(in, line)){
+        // lines cut short by an interrupted run are analysed again
+        if (line.empty() || (line.back() != '}')) continue;
+        if (sscanf(line.c_str(), "{seed=%" SCNu64 ", game=%zu, ply=%u,", &key.seed, &key.game, &key.ply) == 3) done.insert(key);
+    }
+    return done;
+}
+
+void analyse_records(const std::vector<std::string>& record_paths, const std::string& output_path, int depth, float min_prob, float blunder_threshold, size_t n_threads){
+    auto done = read_checkpoint(output_path);
+    std::cout << "Resuming with " << done.size() << " analysed positions" << std::endl;
+    
+    std::ofstream out(output_path, std::ios::app);
+    std::mutex out_lock;
+    
+    // one table per distinct parameter set, shared by all workers
+    std::vector<std::pair<std::array<float, 6>, std::unique_ptr<trans_table>>> tables;
+    
+    std::atomic<size_t> n_blunders(0);
+    std::atomic<size_t> n_analysed(0);
+    size_t n_games = 0;
+    size_t n_skipped = 0;
+    work_stealing_pool pool(n_threads);
+    
+    for (auto& path : record_paths){
+        std::ifstream in(path, std::ios::binary);
+        record_reader reader(in);
+        game_record record;
+        
+        for (size_t game = 0; reader.next(record); ++game){
+            
+            // corrupt records would hand invalid moves to the search, so only records that replay legally are analysed
+            if (!replay_record(record, [](const Board&, const u_int32_t&, const ply_record&){}).legal){
+                std::cout << "Skipping game " << game << " of " << path << " (seed=" << record.header.seed << "): illegal ply" << std::endl;
+                ++n_skipped;
+                continue;
+            }
+            
+            trans_table* T = nullptr;
+            for (auto& t : tables) if (t.first == record.header.params) T = t.second.get();
+            
+            if (T == nullptr){
+                std::vector<float> params(record.header.params.begin(), record.header.params.end());
+                tables.emplace_back(record.header.params, std::unique_ptr<trans_table>(new trans_table(params)));
+                T = tables.back().second.get();
+            }
+            
+            // positions of one game share a queue, idle workers steal from other games
+            size_t queue = n_games++;
+            u_int64_t seed = record.header.seed;
+            replay_record(record, [&](const Board& B, const u_int32_t& ply, const ply_record& p){
+                if (done.count({seed, game, ply})) return;
+                board_t board = B.board;
+                DIRECTION played = (DIRECTION) p.move;
+                
+                pool.submit([=, &out, &out_lock, &n_blunders, &n_analysed]{
+                    position_analysis a = analyse_position(*T, board, played, depth, min_prob, blunder_threshold);
+                    a.seed = seed;
+                    a.game = game;
+                    a.ply = ply;
+                    
+                    std::lock_guard<std::mutex> guard(out_lock);
+                    out << a << std::endl;
+                    n_blunders += a.blunder;
+                    ++n_analysed;
+                }, queue);
+            });
+        }
+    }
+    
+    pool.wait();
+    std::cout << "Games: " << n_games << std::endl;
+    std::cout << "Games skipped: " << n_skipped << std::endl;
+    std::cout << "Positions analysed: " << n_analysed << std::endl;
+    std::cout << "Blunders: " << n_blunders << std::endl;
+}
+
+std::ostream& operator<<(std::ostream& os, const position_analysis& a){
+    os << "{seed=" << a.seed << ", game=" << a.game << ", ply=" << a.ply;
+    os << ", board=0x" << std::hex << std::setw(16) << std::setfill('0') << a.board << std::dec << std::setfill(' ');
+    os << ", played=" << DIRECTION_NAMES[a.played] << ", best=" << DIRECTION_NAMES[a.best];
+    os << ", played_val=" << std::setprecision(8) << a.played_val << ", best_val=" << a.best_val;
+    os << ", loss=" << a.best_val - a.played_val << ", blunder=" << a.blunder << "}";
+    return os;
+}
@@ -1,4 +1,5 @@
 #include "board.hpp"
+#include "cpu_dispatch.hpp"
 
 #if defined( __builtin_popcountll)
 int popcount(const u_int64_t& x){
@@ -12,6 +13,7 @@ int popcount(const u_int64_t& x){
 
 // declaring all global constants from header file
 const DIRECTION DIRECTIONS[8] = {L, LL, R, RR, U, UU, D, DD};
+const char* DIRECTION_NAMES[8] = {"L", "LL", "R", "RR", "U", "UU", "D", "DD"};
 const board_t ROW_MASK = 0x000000000000ffff;
 const board_t COL_MASK = 0x000f000f000f000f;
 const board_t CUBE_MASK = 0x00000000ffffffff;
@@ -74,6 +76,8 @@ const std::array<float, 65536> row_pow_val = init_map_reduce<float>([](board_t v
 const std::array<float, 65536> row_edge_val = func_to_init_vector<float>([](std::vector<board_t> arr) -> float {return edge_pow_value(arr);});
 const std::array<float, 65536> row_mon_vals = func_to_init_vector<float>([](std::vector<board_t> arr) -> float {return row_mon_value(arr);});
 const std::array<int, 65536> n_row_merges = func_to_init_vector<int>([](std::vector<board_t> arr) -> int {return row_merge_score(arr);});
+const std::array<int, 65536> row_zero_count = func_to_init_vector<int>([](std::vector<board_t> arr) -> int {return zero_count(arr);});
+const std::array<u_int8_t, 65536> row_max_key = func_to_init_vector<u_int8_t>([](std::vector<board_t> arr) -> u_int8_t {return row_max_key_value(arr);});
 const std::array<bool, 65536> row_is_terminal = func_to_init_vector<bool>([](std::vector<board_t> arr) -> bool {return is_terminal_row(arr);});
 
 int _popcount(u_int64_t x){
@@ -262,6 +266,13 @@ float edge_pow_value(std::vector<board_t> arr){
     });
 }
 
+// (max value << 4) | position of the max value in the row, ties going to the least significant nibble
+u_int8_t row_max_key_value(std::vector<board_t> arr){
+    u_int8_t res = 0;
+    for (u_int8_t i = 0; i < 4; ++i) res = std::max(res, (u_int8_t) ((arr[i] << 4) | i));
+    return res;
+}
+
 size_t _get(const board_t& board, const size_t& x0, const size_t& x1, const size_t& x2, const size_t& x3){
     assert ((x0 >= 0) && (x0 < 2));
     assert ((x1 >= 0) && (x1 < 2));
@@ -321,15 +332,12 @@ board_t Board::shift_board(const DIRECTION& d) {
     return board;
 }
 
-std::vector<DIRECTION> _valid_moves(const board_t& board){
-    std::vector<DIRECTION> res = {};
-    for (DIRECTION d : DIRECTIONS){
-        if (_shift_board(board, d) != board) res.emplace_back(d);
-    }
-    return res;
+move_list _valid_moves(const board_t& board){
+    board_t children[8];
+    return move_list(KERNELS.successors(board, children));
 }
 
-std::vector<DIRECTION> Board::valid_moves() const {
+move_list Board::valid_moves() const {
     return _valid_moves(board);
 }
 
@@ -337,19 +345,26 @@ u_int16_t Board::valid_move_mask() const {
     return _valid_move_mask(board);
 }
 
-board_t Board::generate_piece(){
+// splitmix64 of the seed and draw counter
+u_int32_t spawn_rng::next(){
+    u_int64_t z = seed + 0x9e3779b97f4a7c15ULL * ++counter;
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return (u_int32_t) ((z ^ (z >> 31)) >> 32);
+}
+
+board_t Board::spawn_piece(const u_int32_t& tile_draw, const u_int32_t& value_draw){
     
     // gets blank tiles
     board_t pos = is_blank(board);
-    if (pos == 0) return false;
     
     // gets random free location
-    uint32_t n_empty_tiles = popcount(pos);
-    board_t randomSetBitIndex = 63 - selectBit(pos, rand() % n_empty_tiles + 1);
+    uint32_t n_empty_tiles = KERNELS.count_blanks(board);
+    board_t randomSetBitIndex = 63 - KERNELS.select_bit(pos, tile_draw % n_empty_tiles + 1);
     board_t randomSetBit = 1;
     
     // determines random piece
-    bool spawn_four = (rand() % 10) ? 0 : 1;
+    bool spawn_four = (value_draw % 10) ? 0 : 1;
     penalty += spawn_four ? 4 : 2;
     randomSetBit <<= (randomSetBitIndex + spawn_four);
     
@@ -358,26 +373,73 @@ board_t Board::generate_piece(){
     return board;
 }
 
+board_t Board::generate_piece(){
+    if (is_blank(board) == 0) return false;
+    u_int32_t tile_draw = rand();
+    u_int32_t value_draw = rand();
+    return spawn_piece(tile_draw, value_draw);
+}
+
+board_t Board::generate_piece(spawn_rng& rng){
+    if (is_blank(board) == 0) return false;
+    u_int32_t tile_draw = rng.next();
+    u_int32_t value_draw = rng.next();
+    return spawn_piece(tile_draw, value_draw);
+}
+
+// places a tile of value 2^val at nibble loc, used to replay recorded spawns
+board_t Board::place_piece(const size_t& loc, const size_t& val){
+    penalty += 1 << val;
+    board = board | ((board_t) val << (4 * loc));
+    return board;
+}
+
+// determines whether 65536 would have spawned
+void Board::check_max_tile(const int& correction){
+    if (correction < 0){
+        penalty -= 557056;
+        max_tile_exceeded = true;
+    }
+}
+
 board_t Board::move(const DIRECTION& d){
     int correction = - (int) count(15);
     
     // only places piece is board state is changed
     if (board != shift_board(d)){
         board = generate_piece();
-        correction += count(15);
-        
-        // determines whether 65536 would have spawned
-        if (correction < 0){
-            penalty -= 557056;
-            max_tile_exceeded = true;
-        }
+        check_max_tile(correction + count(15));
+    }
+    return board;
+}
+
+// performs a move with spawns drawn from a seeded source instead of rand()
+board_t Board::move(const DIRECTION& d, spawn_rng& rng){
+    int correction = - (int) count(15);
+    
+    // only places piece is board state is changed
+    if (board != shift_board(d)){
+        board = generate_piece(rng);
+        check_max_tile(correction + count(15));
+    }
+    return board;
+}
+
+// performs a move with a known spawn instead of a random one
+board_t Board::move(const DIRECTION& d, const size_t& spawn_loc, const size_t& spawn_val){
+    int correction = - (int) count(15);
+    
+    // only places piece is board state is changed
+    if (board != shift_board(d)){
+        board = place_piece(spawn_loc, spawn_val);
+        check_max_tile(correction + count(15));
     }
     return board;
 }
 
 DIRECTION Board::random_move() const {
     u_int16_t moveset = valid_move_mask();
-    return DIRECTIONS[63 - selectBit(moveset, 1 + rand() % popcount(moveset))];
+    return DIRECTIONS[63 - KERNELS.select_bit(moveset, 1 + rand() % popcount(moveset))];
 }
 
 Board generate_game(size_t n_initial_tiles){
@@ -0,0 +1,151 @@
+#include "cpu_dispatch.hpp"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
+const char* ISA_NAMES[4] = {"generic", "bmi2", "avx2", "avx512"};
+
+// generic kernels, built for the baseline instruction set
+
+u_int16_t successors_generic(const board_t& board, board_t* children){
+    const board_t rows[4] = {ROW_MASK & board, ROW_MASK & (board >> 16), ROW_MASK & (board >> 32), ROW_MASK & (board >> 48)};
+    const board_t cols[4] = {col_to_row(COL_MASK & board), col_to_row(COL_MASK & (board >> 4)), col_to_row(COL_MASK & (board >> 8)), col_to_row(COL_MASK & (board >> 12))};
+    return unrolled_successors(board, rows, cols, children);
+}
+
+int count_blanks_generic(const board_t& board){
+    return _popcount(is_blank(board));
+}
+
+board_t permute_generic(const board_t& board, const u_int8_t* perm){
+    board_t res = 0;
+    for (int i = 0; i < 16; ++i) res |= ((board >> (4 * perm[i])) & 0xf) << (4 * i);
+    return res;
+}
+
+void combine_rows_generic(const float* top, const float* second, const float* a0, const float* a1, const float* b0, const float* b1, const float* c0, const float* c1, float* out, const size_t& k){
+    for (size_t i = 0; i < k; ++i){
+        out[i] = top[i] + second[i] + std::max(std::max(a0[i] + a1[i], b0[i] + b1[i]), c0[i] + c1[i]);
+    }
+}
+
+#if defined(__x86_64__)
+
+// BMI2 kernels: PEXT gathers a column into a row index in one instruction
+
+__attribute__((target("bmi2")))
+inline board_t col_index(const board_t& board, const int& shift){
+    return _pext_u64(board >> shift, COL_MASK);
+}
+
+__attribute__((target("bmi2")))
+u_int16_t successors_bmi2(const board_t& board, board_t* children){
+    const board_t rows[4] = {ROW_MASK & board, ROW_MASK & (board >> 16), ROW_MASK & (board >> 32), ROW_MASK & (board >> 48)};
+    const board_t cols[4] = {col_index(board, 0), col_index(board, 4), col_index(board, 8), col_index(board, 12)};
+    return unrolled_successors(board, rows, cols, children);
+}
+
+__attribute__((target("popcnt")))
+int count_blanks_popcnt(const board_t& board){
+    return __builtin_popcountll(is_blank(board));
+}
+
+// PDEP deposits a single bit onto the (popcount - r)th set bit counted from the least significant end
+__attribute__((target("bmi2,popcnt")))
+u_int64_t select_bit_bmi2(u_int64_t v, u_int32_t r){
+    return 63 - __builtin_ctzll(_pdep_u64(1ULL << (_mm_popcnt_u64(v) - r), v));
+}
+
+__attribute__((target("ssse3")))
+board_t permute_ssse3(const board_t& board, const u_int8_t* perm){
+    const __m128i low_nibbles = _mm_set1_epi8(0x0f);
+    __m128i v = _mm_cvtsi64_si128((long long) board);
+    __m128i nibbles = _mm_unpacklo_epi8(_mm_and_si128(v, low_nibbles), _mm_and_si128(_mm_srli_epi16(v, 4), low_nibbles));
+    __m128i shuffled = _mm_shuffle_epi8(nibbles, _mm_loadu_si128((const __m128i*) perm));
+    __m128i pairs = _mm_and_si128(_mm_or_si128(shuffled, _mm_srli_epi16(shuffled, 4)), _mm_set1_epi16(0x00ff));
+    return (board_t) _mm_cvtsi128_si64(_mm_packus_epi16(pairs, pairs));
+}
+
+// AVX2 kernels: gathers measured slower than the scalar BMI2 lookups for successors, so only the batched rows are vectorised
+
+__attribute__((target("avx2")))
+void combine_rows_avx2(const float* top, const float* second, const float* a0, const float* a1, const float* b0, const float* b1, const float* c0, const float* c1, float* out, const size_t& k){
+    size_t i = 0;
+    for (; i + 8 <= k; i += 8){
+        __m256 score0 = _mm256_add_ps(_mm256_loadu_ps(a0 + i), _mm256_loadu_ps(a1 + i));
+        __m256 score1 = _mm256_add_ps(_mm256_loadu_ps(b0 + i), _mm256_loadu_ps(b1 + i));
+        __m256 score2 = _mm256_add_ps(_mm256_loadu_ps(c0 + i), _mm256_loadu_ps(c1 + i));
+        __m256 base = _mm256_add_ps(_mm256_loadu_ps(top + i), _mm256_loadu_ps(second + i));
+        _mm256_storeu_ps(out + i, _mm256_add_ps(base, _mm256_max_ps(_mm256_max_ps(score0, score1), score2)));
+    }
+    combine_rows_generic(top + i, second + i, a0 + i, a1 + i, b0 + i, b1 + i, c0 + i, c1 + i, out + i, k - i);
+}
+
+// AVX-512 kernels
+
+__attribute__((target("avx512f")))
+void combine_rows_avx512(const float* top, const float* second, const float* a0, const float* a1, const float* b0, const float* b1, const float* c0, const float* c1, float* out, const size_t& k){
+    size_t i = 0;
+    for (; i + 16 <= k; i += 16){
+        __m512 score0 = _mm512_add_ps(_mm512_loadu_ps(a0 + i), _mm512_loadu_ps(a1 + i));
+        __m512 score1 = _mm512_add_ps(_mm512_loadu_ps(b0 + i), _mm512_loadu_ps(b1 + i));
+        __m512 score2 = _mm512_add_ps(_mm512_loadu_ps(c0 + i), _mm512_loadu_ps(c1 + i));
+        __m512 base = _mm512_add_ps(_mm512_loadu_ps(top + i), _mm512_loadu_ps(second + i));
+        _mm512_storeu_ps(out + i, _mm512_add_ps(base, _mm512_max_ps(_mm512_max_ps(score0, score1), score2)));
+    }
+    combine_rows_avx2(top + i, second + i, a0 + i, a1 + i, b0 + i, b1 + i, c0 + i, c1 + i, out + i, k - i);
+}
+
+const board_kernels ALL_KERNELS[4] = {
+    {ISA_GENERIC, &successors_generic, &count_blanks_generic, &selectBit, &permute_generic, &combine_rows_generic},
+    {ISA_BMI2, &successors_bmi2, &count_blanks_popcnt, &select_bit_bmi2, &permute_ssse3, &combine_rows_generic},
+    {ISA_AVX2, &successors_bmi2, &count_blanks_popcnt, &select_bit_bmi2, &permute_ssse3, &combine_rows_avx2},
+    {ISA_AVX512, &successors_bmi2, &count_blanks_popcnt, &select_bit_bmi2, &permute_ssse3, &combine_rows_avx512},
+};
+
+bool isa_supported(const ISA_LEVEL& isa){
+    __builtin_cpu_init();
+    switch (isa){
+        case ISA_AVX512: return __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("bmi2");
+        case ISA_AVX2: return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("bmi2");
+        case ISA_BMI2: return __builtin_cpu_supports("bmi2") && __builtin_cpu_supports("ssse3") && __builtin_cpu_supports("popcnt");
+        default: return true;
+    }
+}
+
+#else
+
+const board_kernels ALL_KERNELS[4] = {
+    {ISA_GENERIC, &successors_generic, &count_blanks_generic, &selectBit, &permute_generic, &combine_rows_generic},
+    {ISA_GENERIC, &successors_generic, &count_blanks_generic, &selectBit, &permute_generic, &combine_rows_generic},
+    {ISA_GENERIC, &successors_generic, &count_blanks_generic, &selectBit, &permute_generic, &combine_rows_generic},
+    {ISA_GENERIC, &successors_generic, &count_blanks_generic, &selectBit, &permute_generic, &combine_rows_generic},
+};
+
+bool isa_supported(const ISA_LEVEL& isa){
+    return isa == ISA_GENERIC;
+}
+
+#endif
+
+ISA_LEVEL detect_isa(){
+    int cap = ISA_AVX512;
+    const char* requested = getenv("BOARD_ISA");
+    if (requested){
+        for (int i = 0; i < 4; ++i) if (strcmp(requested, ISA_NAMES[i]) == 0) cap = i;
+    }
+    
+    for (int i = cap; i > 0; --i){
+        if (isa_supported((ISA_LEVEL) i)) return (ISA_LEVEL) i;
+    }
+    return ISA_GENERIC;
+}
+
+const board_kernels& kernels_for(const ISA_LEVEL& isa){
+    return ALL_KERNELS[isa];
+}
+
+const board_kernels KERNELS = kernels_for(detect_isa());
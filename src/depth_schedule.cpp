@@ -0,0 +1,80 @@
+#include "depth_schedule.hpp"
+#include "cpu_dispatch.hpp"
+#include "trans_table.hpp"
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+
+// full depth only for boards about to lock up, shallow search until 4096 is on the board
+const char* DEFAULT_DEPTH_SCHEDULE = "8:merges<=1,empty<=2;6:rank>=12;4";
+
+bool depth_rule::matches(const Board& board) const {
+    return (board.rank() >= min_rank)
+    && ((int) KERNELS.count_blanks(board.board) <= max_empty)
+    && (merge_potential(board.board) <= max_merges);
+}
+
+depth_schedule::depth_schedule(const int& depth) : fallback(depth), spec(std::to_string(depth)) {}
+
+// a whole non-negative number, the spec is quoted in the error
+int parse_number(const std::string& s, const std::string& spec){
+    size_t end = 0;
+    int res = -1;
+    try {
+        res = std::stoi(s, &end);
+    } catch (const std::logic_error&) {}
+    
+    if (s.empty() || (end != s.size()) || (res < 0)) throw std::invalid_argument("invalid number '" + s + "' in depth schedule '" + spec + "'");
+    return res;
+}
+
+depth_schedule::depth_schedule(const std::string& spec) : fallback(-1), spec(spec) {
+    std::stringstream rule_stream(spec);
+    std::string rule_str;
+    
+    while (std::getline(rule_stream, rule_str, ';')){
+        if (fallback >= 0) throw std::invalid_argument("rule '" + rule_str + "' follows a rule without conditions in depth schedule '" + spec + "'");
+        
+        size_t colon = rule_str.find(':');
+        depth_rule r;
+        r.depth = parse_number(rule_str.substr(0, colon), spec);
+        if ((r.depth < 1) || (r.depth >= (int) MAX_DEPTH)) throw std::invalid_argument("depth " + std::to_string(r.depth) + " out of range in depth schedule '" + spec + "'");
+        
+        // a rule without conditions ends the schedule
+        if (colon == std::string::npos){
+            fallback = r.depth;
+            continue;
+        }
+        
+        std::stringstream cond_stream(rule_str.substr(colon + 1));
+        std::string cond;
+        while (std::getline(cond_stream, cond, ',')){
+            if (cond.compare(0, 6, "rank>=") == 0) r.min_rank = parse_number(cond.substr(6), spec);
+            else if (cond.compare(0, 7, "empty<=") == 0) r.max_empty = parse_number(cond.substr(7), spec);
+            else if (cond.compare(0, 8, "merges<=") == 0) r.max_merges = parse_number(cond.substr(8), spec);
+            else throw std::invalid_argument("unknown condition '" + cond + "' in depth schedule '" + spec + "'");
+        }
+        rules.push_back(r);
+    }
+    if (fallback < 0) throw std::invalid_argument("depth schedule '" + spec + "' needs a last rule without conditions");
+}
+
+depth_schedule parse_depth_schedule(const std::string& spec){
+    try {
+        return depth_schedule(spec);
+    } catch (const std::invalid_argument& e) {
+        std::cerr << e.what() << std::endl;
+        exit(1);
+    }
+}
+
+int depth_schedule::depth(const Board& board) const {
+    for (auto& r : rules) if (r.matches(board)) return r.depth;
+    return fallback;
+}
+
+int depth_schedule::max_depth() const {
+    int res = fallback;
+    for (auto& r : rules) res = std::max(res, r.depth);
+    return res;
+}
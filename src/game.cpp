@@ -3,12 +3,18 @@
 typedef std::chrono::time_point<std::chrono::system_clock> time_point;
 auto get_current_time = std::chrono::system_clock::now;
 typedef std::chrono::milliseconds ms;
+typedef std::chrono::microseconds us;
 
 template<typename From>
 ms cast_to_ms(const From& T) {
     return std::chrono::duration_cast<ms>(T);
 };
 
+template<typename From>
+us cast_to_us(const From& T) {
+    return std::chrono::duration_cast<us>(T);
+};
+
 const float FPS_WINDOW = 10.0; // window used to estimate current FPS (seconds)
 const float MIN_FRAME_LENGTH = 0.00; // minimum time between frames (seconds)
 const std::vector<float> PARAMS = {
@@ -20,9 +26,12 @@ const std::vector<float> PARAMS = {
     2.0f,  //monotone curl weight
 };
 
-void display_ai_game(int depth, float min_prob, bool show_analytics){
+void display_ai_game(const depth_schedule& schedule, float min_prob, bool show_analytics, bool ponder){
     srand((u_int32_t) time(NULL));
     trans_table T(PARAMS);
+    
+    // the ponderer owns a thread and a search arena, so it only exists when pondering
+    std::unique_ptr<ponderer> P(ponder ? new ponderer(T) : nullptr);
 
     // generates board
     Board B = generate_game(2);
@@ -53,7 +62,11 @@ void display_ai_game(int depth, float min_prob, bool show_analytics){
         }
         
         // calculates optimal move
-        DIRECTION best_move = T.expectimax(B, depth, min_prob);
+        int depth = schedule.depth(B);
+        DIRECTION best_move = ponder ? P->expectimax(B, depth, min_prob) : T.expectimax(B, depth, min_prob);
+        
+        // searches the spawns of the move while it is committed and rendered
+        if (ponder) P->start(_shift_board(B.board, best_move), schedule, min_prob);
         
         // performs best move
         B.move(best_move);
@@ -88,6 +101,7 @@ void display_ai_game(int depth, float min_prob, bool show_analytics){
         }
     }
     std::cout << "Final Score: " << B.score() << std::endl;
+    if (ponder) std::cout << "Pondered Root Moves: " << P->n_hits << "/" << P->n_root_moves << std::endl;
 }
 
 void display_mcts_game(int n_sims, bool show_analytics){
@@ -152,43 +166,219 @@ void display_mcts_game(int n_sims, bool show_analytics){
     std::cout << "Final Score: " << B.score() << std::endl;
 }
 
-void test_params(int depth, float min_prob, size_t n_sims, std::stringstream& filepath){
-    srand((u_int32_t) time(NULL));
-    filepath << "/2048-4d-ai-test ";
-    filepath << "(D=" << depth;
-    filepath << ", P=" << std::setprecision(5) << min_prob << ").txt";
-    std::cout << "Results output to: " << filepath.str() << std::endl;
+void display_record(const game_record& record, int frame_ms, bool show_analytics){
+    Board initial = Board(record.header.initial_board);
     
-    std::ofstream myfile;
-    myfile.open(filepath.str(), std::ios::app);
+    // outputs initial board
+    std::cout << "      [[ 2048-4D ]]      " << std::endl;
+    std::cout << initial << std::endl;
     
-    trans_table T(PARAMS);
+    if (show_analytics) {
+        std::cout << "      [ Replay ]         " << std::endl;
+        std::cout << "[Ply:                  0]" << std::endl;
+        std::cout << "[BoardEvals:           0]" << std::endl;
+    }
     
+    // draws the board after the first i plies over the previous frame
+    auto draw_frame = [&](const Board& B, const u_int32_t& i){
+        auto frame_start = get_current_time();
+        
+        if (show_analytics) {
+            printf("\e[16A");
+        } else {
+            printf("\e[13A");
+        }
+        
+        printf("\e[K");
+        std::cout << "      [[ 2048-4D ]]      " << std::endl;
+        std::cout << B << std::endl;
+        
+        if (show_analytics) {
+            std::cout << "      [ Replay ]         " << std::endl;
+            std::cout << "[Ply:" << std::setw(19) << i << "]" << std::endl;
+            std::cout << "[BoardEvals:" << std::setw(12) << (record.has_stats() ? record.stats[i-1].n_evals : 0) << "]" << std::endl;
+        }
+        
+        while (cast_to_ms(get_current_time() - frame_start).count() < frame_ms){};
+    };
+    
+    // replays game, the callback sees each board before its ply is applied, so the last board is drawn afterwards
+    replay_result res = replay_record(record, [&](const Board& B, const u_int32_t& i, const ply_record&){
+        if (i > 0) draw_frame(B, i);
+    });
+    if (res.n_plies > 0) draw_frame(res.board, res.n_plies);
+    
+    std::cout << "Final Score: " << res.score << std::endl;
+}
+
+// plays seeded games on the calling thread, keeping n_interleaved searches of different games in flight.
+// spawns are drawn from a spawn_rng per game rather than rand(), which the games would otherwise share
+void play_interleaved_games(trans_table& T, const depth_schedule& schedule, float min_prob, size_t n_sims, size_t n_interleaved, u_int64_t base_seed, std::ofstream& myfile, record_writer& records){
+    struct live_game {
+        Board B;
+        spawn_rng rng;
+        game_record record;
+        time_point search_start;
+    };
+    
+    interleaved_search S(T, n_interleaved);
+    std::vector<live_game> games;
+    size_t n_started = 0;
+    
+    auto new_game = [&](const size_t& slot){
+        u_int64_t seed = base_seed + n_started++;
+        live_game g = {Board(), spawn_rng(seed), game_record(), get_current_time()};
+        g.B.generate_piece(g.rng);
+        g.B.generate_piece(g.rng);
+        g.record = game_record(seed, PARAMS, schedule.max_depth(), min_prob, g.B.board, true);
+        
+        if (slot < games.size()) games[slot] = g;
+        else games.push_back(g);
+        S.start(slot, g.B, schedule.depth(g.B), min_prob);
+    };
+    
+    for (size_t slot = 0; (slot < n_interleaved) && (n_started < n_sims); ++slot) new_game(slot);
+    
+    size_t slot;
+    DIRECTION best_move;
+    u_int64_t n_evals;
+    while (S.next_result(slot, best_move, n_evals)){
+        live_game& g = games[slot];
+        ply_stats stats = {(u_int32_t) n_evals, (u_int32_t) cast_to_us(get_current_time() - g.search_start).count()};
+        
+        // performs best move
+        board_t shifted = _shift_board(g.B.board, best_move);
+        g.B.move(best_move, g.rng);
+        g.record.add_ply(best_move, shifted, g.B.board, stats);
+        
+        if (!g.B.is_terminal()){
+            g.search_start = get_current_time();
+            S.start(slot, g.B, schedule.depth(g.B), min_prob);
+            continue;
+        }
+        
+        g.record.finish(g.B);
+        records.append(g.record);
+        
+        myfile << "{score=" << g.B.score() << ", rank=" << (1 << g.B.rank()) << "}" << std::endl;
+        std::cout << "Final Score: " << g.B.score() << std::endl;
+        
+        if (n_started < n_sims) new_game(slot);
+    }
+}
+
+// plays n_sims recorded games one after another, picking every move with search(B).
+// depth and min_prob are written to the record headers
+template <class F>
+void play_recorded_games(trans_table& T, int depth, float min_prob, size_t n_sims, u_int64_t base_seed, std::ofstream& myfile, record_writer& records, F search){
     for (int i = 0; i < n_sims; ++i){
         
+        // seeds each game separately so that its record can be reproduced
+        u_int64_t seed = base_seed + i;
+        srand((u_int32_t) seed);
+        
         // generates board
         Board B = generate_game(2);
+        game_record record(seed, PARAMS, depth, min_prob, B.board, true);
         
         // plays game
         while (!B.is_terminal()){
+            auto search_start = get_current_time();
+            u_int64_t evals_start = T.b_eval_count.load();
 
             // calculates optimal move
-            DIRECTION best_move = T.expectimax(B, depth, min_prob);
+            DIRECTION best_move = search(B);
+            
+            ply_stats stats = {
+                (u_int32_t) (T.b_eval_count.load() - evals_start),
+                (u_int32_t) cast_to_us(get_current_time() - search_start).count()};
             
             // performs best move
+            board_t shifted = _shift_board(B.board, best_move);
             B.move(best_move);
+            record.add_ply(best_move, shifted, B.board, stats);
             
         }
         
+        record.finish(B);
+        records.append(record);
+        
         myfile << "{score=" << B.score() << ", rank=" << (1 << B.rank()) << "}" << std::endl;
         std::cout << "Final Score: " << B.score() << std::endl;
     }
+}
+
+void test_params(const depth_schedule& schedule, float min_prob, size_t n_sims, std::stringstream& filepath, size_t n_interleaved){
+    u_int64_t base_seed = time(NULL);
+    filepath << "/2048-4d-ai-test ";
+    filepath << "(D=" << schedule.str();
+    filepath << ", P=" << std::setprecision(5) << min_prob << ")";
+    std::cout << "Results output to: " << filepath.str() << ".txt" << std::endl;
+    
+    std::ofstream myfile;
+    myfile.open(filepath.str() + ".txt", std::ios::app);
+    record_writer records(filepath.str() + ".rec");
+    
+    trans_table T(PARAMS);
+    
+    if (n_interleaved > 1){
+        play_interleaved_games(T, schedule, min_prob, n_sims, n_interleaved, base_seed, myfile, records);
+    } else {
+        play_recorded_games(T, schedule.max_depth(), min_prob, n_sims, base_seed, myfile, records, [&](const Board& B){
+            return T.expectimax(B, schedule.depth(B), min_prob);
+        });
+    }
+    
+    myfile.close();
+}
+
+void test_budget(budget_controller budget, const std::string& budget_str, size_t n_sims, std::stringstream& filepath){
+    u_int64_t base_seed = time(NULL);
+    filepath << "/2048-4d-ai-test (B=" << budget_str << ")";
+    std::cout << "Results output to: " << filepath.str() << ".txt" << std::endl;
+    
+    std::ofstream myfile;
+    myfile.open(filepath.str() + ".txt", std::ios::app);
+    record_writer records(filepath.str() + ".rec");
+    
+    trans_table T(PARAMS);
+    
+    // min_prob changes every move, so the headers carry 0
+    play_recorded_games(T, budget.get_max_depth(), 0, n_sims, base_seed, myfile, records, [&](const Board& B){
+        search_params p = budget.next(B);
+        auto search_start = get_current_time();
+        u_int64_t evals_start = T.b_eval_count.load();
+        
+        DIRECTION best_move = T.expectimax(B, p.depth, p.min_prob);
+        budget.record(B, p, T.b_eval_count.load() - evals_start, cast_to_us(get_current_time() - search_start).count());
+        return best_move;
+    });
     
     myfile.close();
 }
 
+// plays a game with spawns drawn from the seed, so games with the same seed share their spawn draws
+Board play_seeded_game(trans_table& T, int depth, float min_prob, board_t initial_pos, size_t terminal_rank, size_t n_gens, u_int64_t seed){
+    spawn_rng rng(seed);
+    Board B = Board(initial_pos);
+    
+    for (int j = 0; j < n_gens; ++j) B.generate_piece(rng);
+    
+    // plays game
+    while ((!B.is_terminal()) && (B.rank() < terminal_rank)){
+        
+        // calculates optimal move
+        DIRECTION best_move = T.expectimax(B, depth, min_prob);
+        
+        // performs best move
+        B.move(best_move, rng);
+    }
+    
+    return B;
+}
+
 // estimates the success probability from a start point of reaching a given rank
-float test_transition(int depth, float min_prob, board_t initial_pos, size_t terminal_rank, std::vector<float> params, size_t n_gens, size_t n_games, bool verbose){
+float test_transition(const depth_schedule& schedule, float min_prob, board_t initial_pos, size_t terminal_rank, std::vector<float> params, size_t n_gens, size_t n_games, bool verbose){
     srand((u_int32_t) time(NULL));
     trans_table T(params);
     
@@ -202,7 +392,7 @@ float test_transition(int depth, float min_prob, board_t initial_pos, size_t ter
         while ((!B.is_terminal()) && (B.rank() < terminal_rank)){
         
             // calculates optimal move
-            DIRECTION best_move = T.expectimax(B, depth, min_prob);
+            DIRECTION best_move = T.expectimax(B, schedule.depth(B), min_prob);
             
             // performs best move
             B.move(best_move);
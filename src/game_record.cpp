@@ -0,0 +1,157 @@
+#include "game_record.hpp"
+#include <cstring>
+
+const u_int32_t RECORD_MAGIC = 0x52443442; // "B4DR"
+const u_int16_t RECORD_VERSION = 1;
+const u_int16_t RECORD_HAS_STATS = 0x1;
+const size_t RECORD_N_PARAMS = 6;
+const size_t RECORD_HEADER_SIZE = 64;
+const u_int8_t NO_SPAWN = 0xff;
+
+// raw little-endian writer, all supported targets are little-endian
+template <class T>
+void put(std::string& buf, const T& x){
+    char bytes[sizeof(T)];
+    std::memcpy(bytes, &x, sizeof(T));
+    buf.append(bytes, sizeof(T));
+}
+
+template <class T>
+T get(const char*& ptr){
+    T x;
+    std::memcpy(&x, ptr, sizeof(T));
+    ptr += sizeof(T);
+    return x;
+}
+
+game_record::game_record(const u_int64_t& seed, const std::vector<float>& params, const int& depth, const float& min_prob, const board_t& initial_board, bool with_stats){
+    header.flags = with_stats ? RECORD_HAS_STATS : 0;
+    header.seed = seed;
+    for (size_t i = 0; (i < params.size()) && (i < RECORD_N_PARAMS); ++i) header.params[i] = params[i];
+    header.depth = depth;
+    header.min_prob = min_prob;
+    header.initial_board = initial_board;
+}
+
+bool game_record::has_stats() const {
+    return header.flags & RECORD_HAS_STATS;
+}
+
+void game_record::add_ply(const DIRECTION& move, const board_t& shifted, const board_t& spawned){
+
+    // the spawned tile is the only nibble that differs from the shifted board
+    board_t diff = shifted ^ spawned;
+    ply_record p = {(u_int8_t) move, NO_SPAWN, 0};
+
+    if (diff){
+        p.spawn_loc = __builtin_ctzll(diff) / 4;
+        p.spawn_val = (spawned >> (4 * p.spawn_loc)) & 0xf;
+    }
+
+    plies.push_back(p);
+    ++header.n_plies;
+}
+
+void game_record::add_ply(const DIRECTION& move, const board_t& shifted, const board_t& spawned, const ply_stats& s){
+    add_ply(move, shifted, spawned);
+    if (has_stats()) stats.push_back(s);
+}
+
+void game_record::finish(const Board& B){
+    header.final_score = B.score();
+}
+
+size_t game_record::serialized_size() const {
+    return RECORD_HEADER_SIZE + plies.size() * 3 + (has_stats() ? plies.size() * sizeof(ply_stats) : 0);
+}
+
+void game_record::serialize(std::string& buf) const {
+    buf.reserve(buf.size() + serialized_size());
+
+    // header (64 bytes)
+    put(buf, RECORD_MAGIC);
+    put(buf, RECORD_VERSION);
+    put(buf, header.flags);
+    put(buf, header.seed);
+    for (auto p : header.params) put(buf, p);
+    put(buf, header.depth);
+    put(buf, header.min_prob);
+    put(buf, header.initial_board);
+    put(buf, header.final_score);
+    put(buf, header.n_plies);
+
+    // plies (3 bytes each)
+    for (auto p : plies){
+        put(buf, p.move);
+        put(buf, p.spawn_loc);
+        put(buf, p.spawn_val);
+    }
+
+    // search statistics (8 bytes each)
+    if (has_stats()){
+        for (auto s : stats){
+            put(buf, s.n_evals);
+            put(buf, s.search_us);
+        }
+    }
+}
+
+record_writer::record_writer(const std::string& filepath){
+    file.open(filepath, std::ios::binary | std::ios::app);
+}
+
+void record_writer::append(const game_record& record){
+
+    // encodes outside of the lock so concurrent games only contend on the write
+    std::string buf;
+    record.serialize(buf);
+
+    std::lock_guard<std::mutex> guard(file_lock);
+    file.write(buf.data(), buf.size());
+}
+
+void record_writer::flush(){
+    std::lock_guard<std::mutex> guard(file_lock);
+    file.flush();
+}
+
+bool record_reader::next(game_record& record){
+    buf.resize(RECORD_HEADER_SIZE);
+    if (!in.read(&buf[0], RECORD_HEADER_SIZE)) return false;
+    
+    // header
+    const char* ptr = buf.data();
+    if (get<u_int32_t>(ptr) != RECORD_MAGIC) return false;
+    if (get<u_int16_t>(ptr) != RECORD_VERSION) return false;
+    
+    record_header& h = record.header;
+    h.flags = get<u_int16_t>(ptr);
+    h.seed = get<u_int64_t>(ptr);
+    for (auto& p : h.params) p = get<float>(ptr);
+    h.depth = get<int32_t>(ptr);
+    h.min_prob = get<float>(ptr);
+    h.initial_board = get<board_t>(ptr);
+    h.final_score = get<int32_t>(ptr);
+    h.n_plies = get<u_int32_t>(ptr);
+    
+    // body
+    size_t body_size = h.n_plies * (3 + (record.has_stats() ? sizeof(ply_stats) : 0));
+    buf.resize(body_size);
+    if (body_size && !in.read(&buf[0], body_size)) return false;
+    ptr = buf.data();
+    
+    record.plies.resize(h.n_plies);
+    for (auto& p : record.plies){
+        p.move = get<u_int8_t>(ptr);
+        p.spawn_loc = get<u_int8_t>(ptr);
+        p.spawn_val = get<u_int8_t>(ptr);
+    }
+    
+    record.stats.resize(record.has_stats() ? h.n_plies : 0);
+    for (auto& s : record.stats){
+        s.n_evals = get<u_int32_t>(ptr);
+        s.search_us = get<u_int32_t>(ptr);
+    }
+    
+    return true;
+}
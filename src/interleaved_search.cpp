@@ -0,0 +1,251 @@
+#include "interleaved_search.hpp"
+
+const int INTERLEAVE_MIN_DEPTH = 2; // shallower probes are too cheap to pay for a switch
+
+// phases of an expectation node
+const u_int8_t ENTER = 0;
+const u_int8_t PROBE = 1;
+const u_int8_t AFTER_2 = 2;
+const u_int8_t AFTER_4 = 3;
+
+// phases of a move node (after ENTER)
+const u_int8_t AFTER_CHILD = 1;
+
+// number of spawns the current tile of an expectation node stands for
+inline float spawn_weight(const search_frame& f){
+    return f.weighted ? f.weights[__builtin_ctzll(f.tile_bit) / 4] : 1;
+}
+
+search_machine::search_machine(trans_table& T) : T(T), cache(arena), stack(2 * MAX_DEPTH + 2), top(0), moves(0), done(true) {}
+
+void search_machine::push_move_node(const board_t& board, const int& depth, const float& prob){
+    search_frame& f = stack[top++];
+    f.board = board;
+    f.depth = depth;
+    f.prob = prob;
+    f.is_move_node = 1;
+    f.phase = ENTER;
+}
+
+void search_machine::push_expectation_node(const board_t& board, const int& depth, const float& prob){
+    search_frame& f = stack[top++];
+    f.board = board;
+    f.depth = depth;
+    f.prob = prob;
+    f.is_move_node = 0;
+    f.phase = ENTER;
+}
+
+// every root move is searched with an empty cache, as trans_table::entry_node does
+void search_machine::start_root_move(){
+    cache.reset();
+    push_expectation_node(_shift_board(root, moves[move_idx]), depth, 1.0);
+}
+
+void search_machine::finish_root_move(){
+    move_scores[move_idx++] = ret;
+    
+    // root moves equivalent to an earlier one take its score, as in trans_table::expectimax
+    for (; symmetric_root && (move_idx < moves.size()) && (reps[moves[move_idx]] != moves[move_idx]); ++move_idx){
+        for (size_t j = 0; j < move_idx; ++j) if (moves[j] == reps[moves[move_idx]]) move_scores[move_idx] = move_scores[j];
+    }
+    
+    if (move_idx < moves.size()){
+        start_root_move();
+        return;
+    }
+
+    // argmax, ties going to the first move as in trans_table::expectimax
+    float best_score = -INFINITY;
+    best = moves[0];
+    for (size_t i = 0; i < moves.size(); ++i){
+        if (move_scores[i] > best_score){
+            best_score = move_scores[i];
+            best = moves[i];
+        }
+    }
+
+    T.b_eval_count += n_evals;
+    thread_leaf_cache().flush_stats(T.leaf_lookups, T.leaf_hits);
+    done = true;
+}
+
+void search_machine::start(const Board& board, const int& depth, const float& min_prob){
+    moves = board.valid_moves();
+    assert (moves.size() > 0);
+    assert ((depth >= 0) && (depth < (int) MAX_DEPTH));
+
+    root = board.board;
+    this->depth = depth;
+    this->min_prob = min_prob;
+    move_idx = 0;
+    n_evals = 0;
+    top = 0;
+    done = false;
+    symmetric_root = T.collapse_symmetries && collapse_moves(root, reps);
+
+    // forces board to make 65536 if it can
+    if (_count(root, 15) == 2){
+        for (auto move : moves){
+            if (_count(_shift_board(root, move), 15) == 1){
+                best = move;
+                done = true;
+                return;
+            }
+        }
+    }
+
+    start_root_move();
+}
+
+bool search_machine::step(){
+    while (!done){
+        search_frame& f = stack[top - 1];
+
+        if (f.is_move_node){
+            if (f.phase == ENTER){
+                ++n_evals;
+                f.move_mask = KERNELS.successors(f.board, f.children);
+
+                // if there are no valid moves, return heuristic
+                if (f.move_mask == 0){
+                    ret = T.heuristic(f.board);
+                    if (--top == 0) finish_root_move();
+                    continue;
+                }
+
+                if ((f.depth > 0) && (f.prob >= min_prob)){
+                    for (u_int16_t m = f.move_mask; m; m &= m - 1) cache.prefetch(f.children[__builtin_ctz(m)]);
+                }
+
+                f.res = -INFINITY;
+                f.phase = AFTER_CHILD;
+                push_expectation_node(f.children[__builtin_ctz(f.move_mask)], f.depth, f.prob);
+
+            } else {
+                f.res = std::max(f.res, ret);
+                f.move_mask &= f.move_mask - 1;
+
+                if (f.move_mask){
+                    push_expectation_node(f.children[__builtin_ctz(f.move_mask)], f.depth, f.prob);
+                } else {
+                    ret = f.res;
+                    if (--top == 0) finish_root_move();
+                }
+            }
+            continue;
+        }
+
+        switch (f.phase){
+            case ENTER:
+                ++n_evals;
+
+                // final layer
+                if ((f.prob < min_prob) || (f.depth <= 0)){
+                    ret = T.leaf_heuristic(f.board);
+                    if (--top == 0) finish_root_move();
+                    break;
+                }
+
+                // yields while the bucket is fetched
+                f.phase = PROBE;
+                if (f.depth >= INTERLEAVE_MIN_DEPTH){
+                    cache.prefetch(f.board);
+                    return false;
+                }
+                break;
+
+            case PROBE: {
+                float res = 0;
+                if (cache.find(f.board, f.depth, min_prob, res)){
+                    ret = res;
+                    if (--top == 0) finish_root_move();
+                    break;
+                }
+
+                f.n_empty_tiles = KERNELS.count_blanks(f.board);
+                assert (f.n_empty_tiles > 0);
+
+                if (T.prove_losses && near_terminal(f.n_empty_tiles) && proven_lost(f.board, std::min(f.depth, PROOF_DEPTH))){
+                    ret = T.non_terminal_heuristic(f.board) - LOSS_PENALTY;
+                    cache.insert(f.board, f.depth, min_prob, ret);
+                    if (--top == 0) finish_root_move();
+                    break;
+                }
+
+                f.factor = f.prob / f.n_empty_tiles;
+                f.res = 0;
+                f.free_tiles = is_blank(f.board);
+                f.weighted = (T.collapse_symmetries && (f.depth >= SYMMETRY_MIN_DEPTH) && collapse_spawns(f.board, f.free_tiles, f.weights))
+                || (T.spawn_samples && (f.depth >= SAMPLE_MIN_DEPTH) && sample_spawns(f.board, T.spawn_samples, f.free_tiles, f.weights));
+                f.tile_bit = 1;
+                while (!(f.free_tiles & 1)){
+                    f.free_tiles >>= 4;
+                    f.tile_bit <<= 4;
+                }
+
+                f.phase = AFTER_2;
+                push_move_node(f.board | f.tile_bit, f.depth - 1, 0.9 * f.factor);
+                break;
+            }
+
+            case AFTER_2:
+                f.res += spawn_weight(f) * 0.9 * ret;
+                f.phase = AFTER_4;
+                push_move_node(f.board | (f.tile_bit << 1), f.depth - 1, 0.1 * f.factor);
+                break;
+
+            case AFTER_4:
+                f.res += spawn_weight(f) * 0.1 * ret;
+
+                // next empty tile
+                do {
+                    f.free_tiles >>= 4;
+                    f.tile_bit <<= 4;
+                } while (f.free_tiles && !(f.free_tiles & 1));
+
+                if (f.free_tiles){
+                    f.phase = AFTER_2;
+                    push_move_node(f.board | f.tile_bit, f.depth - 1, 0.9 * f.factor);
+                } else {
+                    f.res /= f.n_empty_tiles;
+                    cache.insert(f.board, f.depth, min_prob, f.res);
+                    ret = f.res;
+                    if (--top == 0) finish_root_move();
+                }
+                break;
+        }
+    }
+    return true;
+}
+
+interleaved_search::interleaved_search(trans_table& T, const size_t& width) : running(width, false) {
+    assert (width > 0);
+    for (size_t i = 0; i < width; ++i) slots.emplace_back(new search_machine(T));
+}
+
+void interleaved_search::start(const size_t& slot, const Board& board, const int& depth, const float& min_prob){
+    assert ((slot < slots.size()) && !running[slot]);
+    slots[slot]->start(board, depth, min_prob);
+    running[slot] = true;
+    ++n_running;
+}
+
+bool interleaved_search::next_result(size_t& slot, DIRECTION& move, u_int64_t& n_evals){
+    if (n_running == 0) return false;
+
+    // round robin, each search runs to its next cache probe before handing over
+    while (true){
+        for (; cursor < slots.size(); ++cursor){
+            if (!running[cursor] || !slots[cursor]->step()) continue;
+
+            slot = cursor++;
+            move = slots[slot]->result();
+            n_evals = slots[slot]->n_evals;
+            running[slot] = false;
+            --n_running;
+            return true;
+        }
+        cursor = 0;
+    }
+}
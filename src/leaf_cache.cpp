@@ -0,0 +1,24 @@
+#include "leaf_cache.hpp"
+
+const size_t LEAF_CACHE_LOG2 = 14; // 256KB per thread, well inside L2
+
+leaf_cache::leaf_cache(const size_t& log2) : entries(new leaf_entry[(size_t) 1 << log2]()), shift(64 - log2) {
+    assert ((log2 > 0) && (log2 < 32));
+}
+
+void leaf_cache::flush_stats(std::atomic<u_int64_t>& lookups, std::atomic<u_int64_t>& hits){
+    lookups += n_lookups;
+    hits += n_hits;
+    n_lookups = 0;
+    n_hits = 0;
+}
+
+leaf_cache& thread_leaf_cache(){
+    static thread_local leaf_cache cache;
+    return cache;
+}
+
+u_int32_t next_leaf_generation(){
+    static std::atomic<u_int32_t> generation(0);
+    return ++generation;
+}
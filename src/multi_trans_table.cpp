@@ -0,0 +1,189 @@
+#include "multi_trans_table.hpp"
+
+template <size_t K>
+multi_trans_table<K>::multi_trans_table(const std::vector<std::vector<float>>& param_sets) : rows(65536), b_eval_count(0), root_workers(std::min(8u, std::max(1u, std::thread::hardware_concurrency()))) {
+    assert (param_sets.size() == K);
+    
+    // same pre-combined rows as trans_table, one column per parameter set
+    for (board_t row = 0; row < 65536; ++row){
+        for (size_t k = 0; k < K; ++k){
+            const std::vector<float>& params = param_sets[k];
+            float partial_square = params[2] * (row_pow_val[row] + params[4] * row_edge_val[row]);
+            float aug_row_mon = params[5] * row_mon_vals[row];
+            rows[row].top[k] = params[3] * partial_square - aug_row_mon;
+            rows[row].second[k] = partial_square - aug_row_mon;
+            rows[row].partial[k] = 6 * (params[0] * n_row_merges[row] + params[1] * row_zero_count[row]);
+        }
+    }
+}
+
+template <size_t K>
+std::array<float, K> multi_trans_table<K>::non_terminal_heuristic(const board_t& board) const {
+    
+    // the board rearrangement does not depend on the parameters, so it is shared by all sets
+    board_t board0 = fast_reorganize(board);
+    board_t board1 = swap_1_2(board0);
+    board_t board2 = swap_1_3(board0);
+    
+    const multi_row<K>& r3 = rows[ROW_MASK & (board0 >> 48)];
+    const multi_row<K>& r2 = rows[ROW_MASK & (board0 >> 32)];
+    const multi_row<K>& a0 = rows[ROW_MASK & board0];
+    const multi_row<K>& a1 = rows[ROW_MASK & (board0 >> 16)];
+    const multi_row<K>& b0 = rows[ROW_MASK & board1];
+    const multi_row<K>& b1 = rows[ROW_MASK & (board1 >> 16)];
+    const multi_row<K>& c0 = rows[ROW_MASK & board2];
+    const multi_row<K>& c1 = rows[ROW_MASK & (board2 >> 16)];
+    
+    std::array<float, K> res;
+    KERNELS.combine_rows(r3.top, r2.second, a0.partial, a1.partial, b0.partial, b1.partial, c0.partial, c1.partial, res.data(), K);
+    return res;
+}
+
+template <size_t K>
+std::array<float, K> multi_trans_table<K>::heuristic(const board_t& board) const {
+    std::array<float, K> res = non_terminal_heuristic(board);
+    for (auto& x : res) x -= LOSS_PENALTY * _is_terminal(board);
+    return res;
+}
+
+// move node in expectimax, maximising separately for each parameter set
+template <size_t K>
+std::array<float, K> multi_trans_table<K>::move_node(const board_t& board, const int& depth, const float& prob, multi_cached_emax_states_t<K>& cached_emax_values, const float& min_prob){
+    ++b_eval_count;
+    std::array<float, K> res;
+    res.fill(-INFINITY);
+    
+    board_t children[8];
+    u_int16_t move_mask = KERNELS.successors(board, children);
+    
+    // if there are no valid moves, return heuristic
+    if (move_mask == 0){
+        return heuristic(board);
+    }
+    
+    // iterates over valid move set
+    for (; move_mask; move_mask &= move_mask - 1) {
+        std::array<float, K> child = expectation_node(children[__builtin_ctz(move_mask)], depth, prob, cached_emax_values, min_prob);
+        for (size_t k = 0; k < K; ++k) res[k] = std::max(res[k], child[k]);
+    }
+    
+    return res;
+}
+
+// expectation node in expectimax
+template <size_t K>
+std::array<float, K> multi_trans_table<K>::expectation_node(const board_t& board, const int& depth, const float& prob, multi_cached_emax_states_t<K>& cached_emax_values, const float& min_prob){
+    ++b_eval_count;
+    
+    if ((prob < min_prob) || (depth <= 0)){
+        
+        // final layer
+        return non_terminal_heuristic(board);
+    }
+    
+    auto address = cached_emax_values.find(board);
+    
+    // cached expectation layer score
+    if ((address != cached_emax_values.end()) && (address->second.depth >= depth) && (address->second.min_prob <= min_prob)){
+        return address->second.val;
+    }
+    
+    // uncached expectation layer
+    std::array<float, K> res;
+    res.fill(0);
+    board_t free_tiles = is_blank(board);
+    
+    int n_empty_tiles = KERNELS.count_blanks(board);
+    
+    // crowded positions lost under every spawn are scored without expanding them
+    if (prove_losses && near_terminal(n_empty_tiles) && proven_lost(board, std::min(depth, PROOF_DEPTH))){
+        res = non_terminal_heuristic(board);
+        for (auto& x : res) x -= LOSS_PENALTY;
+        cached_emax_values[board] = {res, min_prob, depth};
+        return res;
+    }
+    
+    float factor = prob / n_empty_tiles;
+    
+    // iterates over empty tiles
+    for (board_t randomSetBit = 1; free_tiles; free_tiles >>= 4, randomSetBit <<= 4){
+        
+        if (free_tiles & 1){
+            
+            // places 2 in free tile
+            std::array<float, K> two = move_node(board | randomSetBit, depth-1, 0.9 * factor, cached_emax_values, min_prob);
+            for (size_t k = 0; k < K; ++k) res[k] += 0.9 * two[k];
+            
+            // places 4 in free tile
+            std::array<float, K> four = move_node(board | (randomSetBit << 1), depth-1, 0.1 * factor, cached_emax_values, min_prob);
+            for (size_t k = 0; k < K; ++k) res[k] += 0.1 * four[k];
+        }
+    }
+    
+    for (auto& x : res) x /= n_empty_tiles;
+    
+    cached_emax_values[board] = {res, min_prob, depth};
+    return res;
+}
+
+template <size_t K>
+std::array<float, K> multi_trans_table<K>::entry_node(const board_t& board, const int& depth, const float& min_prob){
+    multi_cached_emax_states_t<K> cached_emax_values = multi_cached_emax_states_t<K>();
+    return expectation_node(board, depth, 1.0, cached_emax_values, min_prob);
+}
+
+template <size_t K>
+std::array<DIRECTION, K> multi_trans_table<K>::expectimax(const Board& board, const int& depth, const float& min_prob){
+    move_list moves = board.valid_moves();
+    assert (moves.size() > 0);
+    assert ((depth >= 0) && (depth < (int) MAX_DEPTH));
+    
+    std::array<DIRECTION, K> res;
+    res.fill(moves[0]);
+    
+    // forces board to make 65536 if it can
+    if (_count(board.board, 15) == 2){
+        for (auto move : moves){
+            if (_count(_shift_board(board.board, move), 15) == 1){
+                res.fill(move);
+                return res;
+            }
+        }
+    }
+    
+    // one search per root move, as in trans_table::expectimax
+    std::array<float, K> move_scores[8];
+    
+    if (MULTITHREADED) {
+        auto search = [&](size_t i){
+            root_caches[i].clear();
+            move_scores[i] = expectation_node(_shift_board(board.board, moves[i]), depth, 1.0, root_caches[i], min_prob);
+        };
+        root_workers.run(moves.size(), search);
+        
+    } else {
+        root_caches[0].clear();
+        for (size_t i = 0; i < moves.size(); ++i){
+            move_scores[i] = expectation_node(_shift_board(board.board, moves[i]), depth, 1.0, root_caches[0], min_prob);
+        }
+    }
+    
+    // argmax for each parameter set
+    for (size_t k = 0; k < K; ++k){
+        float best_score = -INFINITY;
+        
+        for (size_t i = 0; i < moves.size(); ++i){
+            if (move_scores[i][k] > best_score){
+                best_score = move_scores[i][k];
+                res[k] = moves[i];
+            }
+        }
+    }
+    
+    return res;
+}
+
+template class multi_trans_table<1>;
+template class multi_trans_table<2>;
+template class multi_trans_table<4>;
+template class multi_trans_table<8>;
@@ -0,0 +1,101 @@
+#include "ponder.hpp"
+
+const size_t PONDER_MAX_POSITIONS = 32;
+
+ponderer::ponderer(trans_table& T) : T(T), machine(T), stop_requested(false), results(PONDER_MAX_POSITIONS) {
+    worker = std::thread(&ponderer::run, this);
+}
+
+ponderer::~ponderer(){
+    stop();
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        stopping = true;
+    }
+    job_ready.notify_all();
+    worker.join();
+}
+
+void ponderer::run(){
+    while (true){
+        {
+            std::unique_lock<std::mutex> guard(lock);
+            job_ready.wait(guard, [&]{return stopping || has_job;});
+            if (stopping) return;
+            has_job = false;
+        }
+        
+        ponder();
+        
+        std::lock_guard<std::mutex> guard(lock);
+        busy = false;
+        job_done.notify_all();
+    }
+}
+
+void ponderer::ponder(){
+    n_results = 0;
+    board_t free_tiles = is_blank(afterstate);
+    
+    // a 2 is nine times as likely as a 4 on any tile, so every 2 is searched first
+    for (int shift = 0; shift < 2; ++shift){
+        for (board_t tiles = free_tiles; tiles; tiles &= tiles - 1){
+            if (stop_requested || (n_results == PONDER_MAX_POSITIONS)) return;
+            
+            Board child = Board(afterstate | ((tiles & -tiles) << shift));
+            if (child.is_terminal()) continue;
+            
+            int depth = schedule->depth(child);
+            machine.start(child, depth, min_prob);
+            while (!machine.step()){
+                if (stop_requested) break;
+            }
+            if (!machine.finished()) T.b_eval_count += machine.n_evals;
+            
+            root_scores& r = results[n_results++];
+            r.board = child.board;
+            r.depth = depth;
+            r.min_prob = min_prob;
+            r.known_mask = 0;
+            
+            const move_list& moves = machine.root_moves();
+            for (size_t i = 0; i < machine.n_moves_searched(); ++i){
+                r.known_mask |= 1 << moves[i];
+                r.scores[moves[i]] = machine.move_score(i);
+            }
+        }
+    }
+}
+
+void ponderer::start(const board_t& afterstate, const depth_schedule& schedule, const float& min_prob){
+    stop();
+    
+    std::lock_guard<std::mutex> guard(lock);
+    this->afterstate = afterstate;
+    this->schedule = &schedule;
+    this->min_prob = min_prob;
+    stop_requested = false;
+    has_job = true;
+    busy = true;
+    job_ready.notify_all();
+}
+
+void ponderer::stop(){
+    stop_requested = true;
+    std::unique_lock<std::mutex> guard(lock);
+    job_done.wait(guard, [&]{return !busy;});
+}
+
+DIRECTION ponderer::expectimax(const Board& board, const int& depth, const float& min_prob){
+    stop();
+    
+    const root_scores* known = nullptr;
+    for (size_t i = 0; i < n_results; ++i){
+        if (results[i].matches(board.board, depth, min_prob)) known = &results[i];
+    }
+    
+    n_root_moves += board.valid_moves().size();
+    if (known) n_hits += __builtin_popcount(known->known_mask);
+    
+    return T.expectimax(board, depth, min_prob, known);
+}
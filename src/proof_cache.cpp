@@ -0,0 +1,50 @@
+#include "proof_cache.hpp"
+#include <robin_hood.h>
+
+const int PROOF_DEPTH = 2;
+const int PROOF_MAX_EMPTY = 2;
+const size_t PROOF_CACHE_SIZE = 1 << 20;
+
+// smallest k the board is proven lost within, and largest k it is proven to survive
+struct proof_entry {
+    int8_t lost_within = 127;
+    int8_t alive_for = 0;
+};
+
+thread_local robin_hood::unordered_flat_map<board_t, proof_entry> proof_cache;
+
+bool proven_lost(const board_t& board, const int& k){
+    int n_empty_tiles = KERNELS.count_blanks(board);
+    
+    // unproven rather than disproven, crowding is only a cost limit
+    if ((n_empty_tiles == 0) || !near_terminal(n_empty_tiles)) return false;
+    
+    auto address = proof_cache.find(board);
+    if (address != proof_cache.end()){
+        if (address->second.lost_within <= k) return true;
+        if (address->second.alive_for >= k) return false;
+    }
+    
+    // the position survives if some spawn leaves a move that is not itself lost within k - 1
+    bool lost = true;
+    board_t free_tiles = is_blank(board);
+    for (board_t randomSetBit = 1; free_tiles && lost; free_tiles >>= 4, randomSetBit <<= 4){
+        if (!(free_tiles & 1)) continue;
+        
+        for (board_t spawn = randomSetBit; spawn <= (randomSetBit << 1); spawn <<= 1){
+            board_t children[8];
+            u_int16_t move_mask = KERNELS.successors(board | spawn, children);
+            
+            for (; move_mask && lost; move_mask &= move_mask - 1){
+                lost = (k > 1) && proven_lost(children[__builtin_ctz(move_mask)], k - 1);
+            }
+            if (!lost) break;
+        }
+    }
+    
+    if (proof_cache.size() >= PROOF_CACHE_SIZE) proof_cache.clear();
+    proof_entry& e = proof_cache[board];
+    if (lost) e.lost_within = std::min<int>(e.lost_within, k);
+    else e.alive_for = std::max<int>(e.alive_for, k);
+    return lost;
+}
@@ -0,0 +1,81 @@
+#include "search_arena.hpp"
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <sys/mman.h>
+
+const size_t SEARCH_ARENA_BYTES = 32 << 20; // every size a trans_cache doubles through
+
+const size_t HUGE_PAGE_BYTES = 2 << 20;
+
+search_arena::search_arena(const size_t& capacity) : capacity(capacity), offset(0), high_water(0), gen(1) {
+    
+    // over-reserves by one huge page so the arena can start on a huge page boundary
+    void* p = mmap(nullptr, capacity + HUGE_PAGE_BYTES, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (p == MAP_FAILED) throw std::bad_alloc();
+    base = (char*) (((uintptr_t) p + HUGE_PAGE_BYTES - 1) & ~(uintptr_t) (HUGE_PAGE_BYTES - 1));
+    
+    // the unused head and tail are given back
+    size_t head = base - (char*) p;
+    if (head) munmap(p, head);
+    if (HUGE_PAGE_BYTES - head) munmap(base + capacity, HUGE_PAGE_BYTES - head);
+    
+#ifdef MADV_HUGEPAGE
+    madvise(base, capacity, MADV_HUGEPAGE);
+#endif
+}
+
+search_arena::~search_arena(){
+    munmap(base, capacity);
+}
+
+void* search_arena::allocate(const size_t& n_bytes, const size_t& alignment){
+    assert ((alignment & (alignment - 1)) == 0);
+    size_t start = (offset + alignment - 1) & ~(alignment - 1);
+    if (start + n_bytes > capacity) return nullptr;
+    
+    offset = start + n_bytes;
+    high_water = std::max(high_water, offset);
+    return base + start;
+}
+
+void search_arena::reset(){
+    offset = 0;
+    
+    // generation 0 marks never written memory, so touched memory is zeroed again once every 255 searches
+    if (++gen == 0){
+#ifdef MADV_DONTNEED
+        madvise(base, high_water, MADV_DONTNEED);
+#else
+        std::memset(base, 0, high_water);
+#endif
+        high_water = 0;
+        gen = 1;
+    }
+}
+
+void arena_return::operator()(search_arena* arena) const {
+    pool->release(arena);
+}
+
+arena_ptr arena_pool::acquire(){
+    search_arena* arena = nullptr;
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        if (!idle.empty()){
+            arena = idle.back().release();
+            idle.pop_back();
+        }
+    }
+    
+    if (arena) arena->reset();
+    else arena = new search_arena();
+    return arena_ptr(arena, arena_return{this});
+}
+
+void arena_pool::release(search_arena* arena){
+    std::lock_guard<std::mutex> guard(lock);
+    idle.emplace_back(arena);
+}
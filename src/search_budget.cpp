@@ -0,0 +1,61 @@
+#include "search_budget.hpp"
+#include "cpu_dispatch.hpp"
+
+const float BUDGET_MIN_PROB_FLOOR = 1e-5;
+const float BUDGET_MIN_PROB_CEIL = 0.5;
+const float BUDGET_LEARNING_RATE = 0.5;
+
+budget_controller::budget_controller(const u_int64_t& node_budget, const int& max_depth) : node_budget(node_budget), time_budget_us(0), max_depth(max_depth), evals_per_us(15) {
+    assert ((node_budget > 0) && (max_depth > 0));
+    
+    // about 1M evaluations at min_prob 0.01 on mid-game boards
+    for (auto& s : log_scale) s = 7.0;
+}
+
+budget_controller budget_controller::for_time(const u_int64_t& time_budget_us, const int& max_depth){
+    budget_controller res(1, max_depth);
+    res.time_budget_us = time_budget_us;
+    return res;
+}
+
+// crowded boards grow faster as min_prob falls, the tree is only cut by depth and the chance nodes are narrow
+float budget_controller::slope(const int& n_empty) const {
+    return std::max(1.25f, 2.4f - 0.2f * n_empty);
+}
+
+u_int64_t budget_controller::current_node_budget() const {
+    if (time_budget_us) return std::max((u_int64_t) 1, (u_int64_t) (time_budget_us * evals_per_us));
+    return node_budget;
+}
+
+float budget_controller::predicted_evals(const board_t& board, const search_params& p) const {
+    int n_empty = KERNELS.count_blanks(board);
+    return expf(log_scale[n_empty] + slope(n_empty) * logf(1 / p.min_prob));
+}
+
+search_params budget_controller::next(const Board& board) const {
+    int n_empty = KERNELS.count_blanks(board.board);
+    
+    float log_inv_prob = (logf((float) current_node_budget()) - log_scale[n_empty]) / slope(n_empty);
+    float min_prob = std::min(BUDGET_MIN_PROB_CEIL, std::max(BUDGET_MIN_PROB_FLOOR, expf(-log_inv_prob)));
+    
+    // a chance node divides the probability by at least n_empty / 0.9, so deeper layers would all be cut by min_prob.
+    // one layer of slack covers boards that empty out as the search goes down
+    float layer_factor = std::max(2, n_empty) / 0.9f;
+    int depth = 2 + (int) (logf(1 / min_prob) / logf(layer_factor));
+    
+    return {std::min(max_depth, depth), min_prob};
+}
+
+void budget_controller::record(const Board& board, const search_params& p, const u_int64_t& n_evals, const u_int64_t& search_us){
+    if (n_evals == 0) return;
+    int n_empty = KERNELS.count_blanks(board.board);
+    
+    // moves neighbouring counts halfway as well, since they are seen less often
+    float err = logf((float) n_evals) - logf(predicted_evals(board.board, p));
+    log_scale[n_empty] += BUDGET_LEARNING_RATE * err;
+    if (n_empty > 0) log_scale[n_empty - 1] += 0.5 * BUDGET_LEARNING_RATE * err;
+    if (n_empty < 16) log_scale[n_empty + 1] += 0.5 * BUDGET_LEARNING_RATE * err;
+    
+    if (search_us) evals_per_us = 0.8 * evals_per_us + 0.2 * ((float) n_evals / search_us);
+}
@@ -0,0 +1,33 @@
+#include "spawn_sampling.hpp"
+
+const int SAMPLE_MIN_DEPTH = 2; // the last chance layer is cheap enough to expand exactly
+
+// splitmix64 finaliser
+constexpr u_int64_t board_hash(const board_t& board){
+    u_int64_t z = board + 0x9E3779B97F4A7C15ULL;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+bool sample_spawns(const board_t& board, const size_t& n_samples, board_t& free_tiles, u_int8_t* weights){
+    u_int8_t cells[16];
+    size_t n_empty = 0;
+    for (size_t a = 0; a < 16; ++a) if ((free_tiles >> (4 * a)) & 1) cells[n_empty++] = a;
+    if (n_empty <= n_samples) return false;
+    
+    // 4 bits of the hash per stratum
+    u_int64_t h = board_hash(board);
+    board_t sampled = 0;
+    for (size_t s = 0; s < n_samples; ++s, h >>= 4){
+        size_t begin = s * n_empty / n_samples;
+        size_t size = (s + 1) * n_empty / n_samples - begin;
+        u_int8_t cell = cells[begin + (h & 0xf) % size];
+        
+        sampled |= (board_t) 1 << (4 * cell);
+        weights[cell] = size;
+    }
+    
+    free_tiles = sampled;
+    return true;
+}
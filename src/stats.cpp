@@ -0,0 +1,239 @@
+#include "stats.hpp"
+
+const float SKETCH_ACCURACY = 0.005; // relative accuracy of sketch quantiles
+const float CONFIDENCE_Z = 1.96; // 95% confidence intervals
+
+quantile_sketch::quantile_sketch(const float& accuracy){
+    gamma = (1 + accuracy) / (1 - accuracy);
+    log_gamma = log(gamma);
+}
+
+void quantile_sketch::add(const float& x){
+    ++n;
+    if (x <= 0){
+        ++zero_count;
+    } else {
+        ++buckets[(int) ceil(log(x) / log_gamma)];
+    }
+}
+
+void quantile_sketch::merge(const quantile_sketch& other){
+    assert (gamma == other.gamma);
+    n += other.n;
+    zero_count += other.zero_count;
+    for (auto& b : other.buckets) buckets[b.first] += b.second;
+}
+
+// value of the element with the given 0-indexed rank, to within the sketch accuracy
+float quantile_sketch::value_at_rank(const float& rank) const {
+    if (n == 0) return NAN;
+    if (rank < zero_count) return 0;
+    
+    u_int64_t seen = zero_count;
+    for (auto& b : buckets){
+        seen += b.second;
+        if (seen > rank) return 2 * pow(gamma, b.first) / (gamma + 1);
+    }
+    return 2 * pow(gamma, buckets.rbegin()->first) / (gamma + 1);
+}
+
+float quantile_sketch::quantile(const float& q) const {
+    return value_at_rank(q * (n - 1));
+}
+
+std::pair<float, float> quantile_sketch::quantile_interval(const float& q, const float& z) const {
+    float half_width = z * sqrt(n * q * (1 - q));
+    float lo = std::max(0.0f, q * (n - 1) - half_width);
+    float hi = std::min((float) (n - 1), q * (n - 1) + half_width);
+    return {value_at_rank(floor(lo)), value_at_rank(ceil(hi))};
+}
+
+void quantile_sketch::save(std::ostream& os) const {
+    
+    // merging checks that gamma matches exactly, so it is written at full precision
+    os << std::setprecision(17) << gamma << " " << n << " " << zero_count << " " << buckets.size();
+    for (auto& b : buckets) os << " " << b.first << " " << b.second;
+    os << std::endl;
+}
+
+void quantile_sketch::load(std::istream& is){
+    size_t n_buckets;
+    int idx;
+    u_int64_t count;
+    is >> gamma >> n >> zero_count >> n_buckets;
+    log_gamma = log(gamma);
+    
+    buckets.clear();
+    for (size_t i = 0; i < n_buckets; ++i){
+        is >> idx >> count;
+        buckets[idx] = count;
+    }
+}
+
+void running_moments::add(const double& x){
+    ++n;
+    double delta = x - mean;
+    mean += delta / n;
+    m2 += delta * (x - mean);
+}
+
+void running_moments::merge(const running_moments& other){
+    if (other.n == 0) return;
+    u_int64_t total = n + other.n;
+    double delta = other.mean - mean;
+    mean += delta * other.n / total;
+    m2 += other.m2 + delta * delta * ((double) n * other.n / total);
+    n = total;
+}
+
+double running_moments::variance() const {
+    return (n > 1) ? m2 / (n - 1) : 0;
+}
+
+std::pair<double, double> running_moments::mean_interval(const float& z) const {
+    double half_width = (n > 0) ? z * sqrt(variance() / n) : 0;
+    return {mean - half_width, mean + half_width};
+}
+
+std::pair<float, float> proportion_interval(const u_int64_t& successes, const u_int64_t& n, const float& z){
+    if (n == 0) return {0, 1};
+    float p = (float) successes / n;
+    float denom = 1 + z * z / n;
+    float centre = (p + z * z / (2 * n)) / denom;
+    float half_width = z * sqrt(p * (1 - p) / n + z * z / (4.0f * n * n)) / denom;
+    return {std::max(0.0f, centre - half_width), std::min(1.0f, centre + half_width)};
+}
+
+void result_stats::add_game(const int& score, const size_t& rank){
+    ++n_games;
+    ++rank_counts[std::min(rank, (size_t) 16)];
+    score_moments.add(score);
+    scores.add(score);
+}
+
+void result_stats::add_record(const game_record& record){
+    replay_result res = replay_record(record, [](const Board&, const u_int32_t&, const ply_record&){});
+    add_game(record.header.final_score, res.rank);
+    plies.add(res.n_plies);
+    
+    // moves per second of search time, only known when the record has search statistics
+    if (record.has_stats() && res.n_plies){
+        u_int64_t search_us = 0;
+        for (auto& s : record.stats) search_us += s.search_us;
+        if (search_us) moves_per_second.add(1e6f * res.n_plies / search_us);
+    }
+}
+
+void result_stats::merge(const result_stats& other){
+    n_games += other.n_games;
+    for (int i = 0; i < 17; ++i) rank_counts[i] += other.rank_counts[i];
+    score_moments.merge(other.score_moments);
+    scores.merge(other.scores);
+    plies.merge(other.plies);
+    moves_per_second.merge(other.moves_per_second);
+}
+
+bool ends_with(const std::string& s, const std::string& suffix){
+    return (s.size() >= suffix.size()) && (s.compare(s.size() - suffix.size(), suffix.size(), suffix) == 0);
+}
+
+void result_stats::add_file(const std::string& path){
+    
+    if (ends_with(path, ".rec")){
+        std::ifstream in(path, std::ios::binary);
+        record_reader reader(in);
+        game_record record;
+        while (reader.next(record)) add_record(record);
+        
+    } else if (ends_with(path, ".shard")){
+        std::ifstream in(path);
+        result_stats shard;
+        shard.load(in);
+        merge(shard);
+        
+    } else {
+        std::ifstream in(path);
+        std::string line;
+        int score;
+        size_t tile;
+        
+        while (std::getline(in, line)){
+            if (sscanf(line.c_str(), "{score=%d, rank=%zu}", &score, &tile) == 2){
+                size_t rank = 0;
+                while (tile > 1){tile >>= 1; ++rank;}
+                add_game(score, rank);
+            }
+        }
+    }
+}
+
+void save_moments(std::ostream& os, const running_moments& m){
+    os << m.n << " " << std::setprecision(17) << m.mean << " " << m.m2 << std::endl;
+}
+
+void load_moments(std::istream& is, running_moments& m){
+    is >> m.n >> m.mean >> m.m2;
+}
+
+void result_stats::save(std::ostream& os) const {
+    os << "result_stats 1" << std::endl;
+    os << n_games;
+    for (int i = 0; i < 17; ++i) os << " " << rank_counts[i];
+    os << std::endl;
+    save_moments(os, score_moments);
+    scores.save(os);
+    save_moments(os, plies);
+    moves_per_second.save(os);
+}
+
+void result_stats::load(std::istream& is){
+    std::string tag;
+    int version;
+    is >> tag >> version;
+    assert ((tag == "result_stats") && (version == 1));
+    
+    is >> n_games;
+    for (int i = 0; i < 17; ++i) is >> rank_counts[i];
+    load_moments(is, score_moments);
+    scores.load(is);
+    load_moments(is, plies);
+    moves_per_second.load(is);
+}
+
+void result_stats::report(std::ostream& os) const {
+    os << "Games: " << n_games << std::endl << std::endl;
+    if (n_games == 0) return;
+    
+    // proportion of games reaching at least each tile
+    os << "|Tile|Proportion of games <br /> tile achieved|95% CI|" << std::endl;
+    os << "|:-:|:-:|:-:|" << std::endl;
+    u_int64_t at_least = n_games;
+    for (int rank = 0; rank < 17; ++rank){
+        if (rank >= 11){
+            auto ci = proportion_interval(at_least, n_games);
+            os << "|" << (1 << rank) << "|" << std::fixed << std::setprecision(1) << 100.0 * at_least / n_games << "%|";
+            os << 100 * ci.first << "% - " << 100 * ci.second << "%|" << std::endl;
+        }
+        at_least -= rank_counts[rank];
+    }
+    os << std::defaultfloat << std::endl;
+    
+    auto mean_ci = score_moments.mean_interval();
+    os << std::fixed << std::setprecision(0);
+    os << "Mean Score: " << score_moments.mean << " (95% CI " << mean_ci.first << " - " << mean_ci.second << ")" << std::endl;
+    for (float q : {0.0f, 0.1f, 0.25f, 0.5f, 0.75f, 0.9f, 1.0f}){
+        auto ci = scores.quantile_interval(q);
+        os << "Score Q" << std::setprecision(2) << q << ": " << std::setprecision(0) << scores.quantile(q);
+        os << " (95% CI " << ci.first << " - " << ci.second << ")" << std::endl;
+    }
+    
+    os << std::setprecision(1);
+    if (plies.n) os << "Mean Moves: " << plies.mean << std::endl;
+    if (moves_per_second.n){
+        auto mps_ci = moves_per_second.quantile_interval(0.5);
+        os << "Moves/s Q0.1: " << moves_per_second.quantile(0.1) << std::endl;
+        os << "Moves/s Q0.5: " << moves_per_second.quantile(0.5) << " (95% CI " << mps_ci.first << " - " << mps_ci.second << ")" << std::endl;
+        os << "Moves/s Q0.9: " << moves_per_second.quantile(0.9) << std::endl;
+    }
+    os << std::defaultfloat;
+}
@@ -0,0 +1,124 @@
+#include "symmetry.hpp"
+
+const size_t N_SYMMETRIES = 384;
+const int SYMMETRY_MIN_DEPTH = 2; // shallower chance nodes are cheaper to search than to collapse
+const size_t SYMMETRY_MAX_CANDIDATES = 96;
+
+symmetry_group::symmetry_group(){
+    
+    // applying a symmetry to a board holding each location's index records where every nibble comes from
+    const board_t index_board = 0xfedcba9876543210;
+    size_t n_sending[16][16] = {};
+    
+    for (size_t g = 0; g < N_SYMMETRIES; ++g){
+        size_t flips = g & 15;
+        size_t axes = g >> 4;
+        
+        board_t b = index_board;
+        for (size_t i = 0; i < 4; ++i) if ((flips >> i) & 1) b = flip(b, i);
+        
+        size_t c1 = axes % 4, c2 = (axes / 4) % 3, c3 = axes / 12;
+        b = (c1 == 1) ? swap_2_3(b) : (c1 == 2) ? swap_1_3(b) : (c1 == 3) ? swap_0_3(b) : b;
+        b = (c2 == 1) ? swap_1_2(b) : (c2 == 2) ? swap_0_2(b) : b;
+        b = c3 ? swap_0_1(b) : b;
+        
+        for (size_t i = 0; i < 16; ++i){
+            perms[g][i] = (b >> (4 * i)) & 0xf;
+            cell_image[g][perms[g][i]] = i;
+        }
+        for (size_t a = 0; a < 16; ++a){
+            size_t img = cell_image[g][a];
+            sending[a][img][n_sending[a][img]++] = g;
+        }
+        
+        // a move commutes with the symmetry up to a relabelling of directions, found as the only direction
+        // that agrees on a set of pseudo-random boards
+        for (size_t d = 0; d < 8; ++d){
+            u_int16_t candidates = 0xff;
+            board_t probe = 0x9E3779B97F4A7C15;
+            for (size_t t = 0; t < 64; ++t){
+                probe = probe * 6364136223846793005ULL + 1442695040888963407ULL;
+                board_t b = probe & 0x3333333333333333;
+                board_t moved = apply_permutation(_shift_board(b, DIRECTIONS[d]), perms[g]);
+                board_t image = apply_permutation(b, perms[g]);
+                for (size_t e = 0; e < 8; ++e){
+                    if (_shift_board(image, DIRECTIONS[e]) != moved) candidates &= ~(1 << e);
+                }
+            }
+            assert (__builtin_popcount(candidates) == 1);
+            move_image[g][d] = __builtin_ctz(candidates);
+        }
+    }
+}
+
+const symmetry_group& symmetries(){
+    static const symmetry_group group;
+    return group;
+}
+
+size_t stabilizer(const board_t& board, u_int16_t* elements){
+    
+    // a symmetry fixing the board permutes the cells holding any one value, so the first cell of the rarest value
+    // has to go to one of them
+    u_int8_t counts[16] = {};
+    for (board_t tmp = board, i = 0; i < 16; tmp >>= 4, ++i) ++counts[tmp & 0xf];
+    
+    size_t rarest = 0;
+    for (size_t v = 1; v < 16; ++v){
+        if (counts[v] && (!counts[rarest] || (counts[v] < counts[rarest]))) rarest = v;
+    }
+    
+    elements[0] = 0;
+    if (24 * counts[rarest] > SYMMETRY_MAX_CANDIDATES) return 1;
+    
+    size_t first = 0;
+    while (((board >> (4 * first)) & 0xf) != rarest) ++first;
+    
+    const symmetry_group& group = symmetries();
+    size_t n = 1;
+    for (size_t i = first; i < 16; ++i){
+        if (((board >> (4 * i)) & 0xf) != rarest) continue;
+        for (auto g : group.sending[first][i]){
+            if ((g != 0) && (apply_symmetry(board, g) == board)) elements[n++] = g;
+        }
+    }
+    return n;
+}
+
+bool collapse_spawns(const board_t& board, board_t& free_tiles, u_int8_t* weights){
+    u_int16_t elements[SYMMETRY_MAX_CANDIDATES + 1];
+    size_t n = stabilizer(board, elements);
+    if (n == 1) return false;
+    
+    // every cell is represented by the lowest cell of its orbit
+    const symmetry_group& group = symmetries();
+    u_int8_t reps[16];
+    for (size_t a = 0; a < 16; ++a){
+        reps[a] = a;
+        for (size_t k = 1; k < n; ++k) reps[a] = std::min(reps[a], group.cell_image[elements[k]][a]);
+    }
+    
+    board_t collapsed = 0;
+    for (size_t a = 0; a < 16; ++a) weights[a] = 0;
+    for (size_t a = 0; a < 16; ++a){
+        if (!((free_tiles >> (4 * a)) & 1)) continue;
+        ++weights[reps[a]];
+        if (reps[a] == a) collapsed |= (board_t) 1 << (4 * a);
+    }
+    
+    free_tiles = collapsed;
+    return true;
+}
+
+bool collapse_moves(const board_t& board, DIRECTION* reps){
+    u_int16_t elements[SYMMETRY_MAX_CANDIDATES + 1];
+    size_t n = stabilizer(board, elements);
+    if (n == 1) return false;
+    
+    const symmetry_group& group = symmetries();
+    for (size_t d = 0; d < 8; ++d){
+        reps[d] = (DIRECTION) d;
+        for (size_t k = 1; k < n; ++k) reps[d] = std::min(reps[d], (DIRECTION) group.move_image[elements[k]][d]);
+    }
+    return true;
+}
@@ -0,0 +1,169 @@
+#include "thread_pool.hpp"
+
+work_stealing_pool::work_stealing_pool(size_t n_threads) : n_queued(0), n_pending(0), next_queue(0) {
+    if (n_threads == 0) n_threads = 1;
+    
+    for (size_t i = 0; i < n_threads; ++i) queues.emplace_back(new worker_queue());
+    for (size_t i = 0; i < n_threads; ++i) workers.emplace_back(&work_stealing_pool::run, this, i);
+}
+
+work_stealing_pool::~work_stealing_pool(){
+    {
+        std::lock_guard<std::mutex> guard(state_lock);
+        stopping = true;
+    }
+    work_available.notify_all();
+    for (auto& w : workers) w.join();
+}
+
+size_t work_stealing_pool::size() const {
+    return workers.size();
+}
+
+void work_stealing_pool::submit(std::function<void()> task){
+    submit(std::move(task), next_queue++);
+}
+
+void work_stealing_pool::submit(std::function<void()> task, const size_t& hint){
+    ++n_pending;
+    {
+        worker_queue& q = *queues[hint % queues.size()];
+        std::lock_guard<std::mutex> guard(q.lock);
+        q.tasks.push_back(std::move(task));
+    }
+    {
+        std::lock_guard<std::mutex> guard(state_lock);
+        ++n_queued;
+    }
+    work_available.notify_one();
+}
+
+void work_stealing_pool::wait(){
+    std::unique_lock<std::mutex> guard(state_lock);
+    work_done.wait(guard, [this]{return n_pending == 0;});
+}
+
+// owner takes the newest task from its own queue
+bool work_stealing_pool::try_pop(const size_t& idx, std::function<void()>& task){
+    worker_queue& q = *queues[idx];
+    std::lock_guard<std::mutex> guard(q.lock);
+    if (q.tasks.empty()) return false;
+    task = std::move(q.tasks.back());
+    q.tasks.pop_back();
+    return true;
+}
+
+// thieves take the oldest task from another queue
+bool work_stealing_pool::try_steal(const size_t& idx, std::function<void()>& task){
+    for (size_t i = 1; i < queues.size(); ++i){
+        worker_queue& q = *queues[(idx + i) % queues.size()];
+        std::lock_guard<std::mutex> guard(q.lock);
+        if (q.tasks.empty()) continue;
+        task = std::move(q.tasks.front());
+        q.tasks.pop_front();
+        return true;
+    }
+    return false;
+}
+
+void work_stealing_pool::run(const size_t& idx){
+    std::function<void()> task;
+    
+    while (true){
+        {
+            std::unique_lock<std::mutex> guard(state_lock);
+            work_available.wait(guard, [this]{return stopping || (n_queued > 0);});
+            if (n_queued == 0) return;
+            --n_queued;
+        }
+        
+        // a task is reserved for this worker, so one of the queues holds it
+        while (!try_pop(idx, task) && !try_steal(idx, task)){};
+        task();
+        task = nullptr;
+        
+        if (--n_pending == 0){
+            std::lock_guard<std::mutex> guard(state_lock);
+            work_done.notify_all();
+        }
+    }
+}
+
+batch_pool::batch_pool(size_t n_threads) : n_threads(n_threads), next_task(0) {}
+
+batch_pool::~batch_pool(){
+    {
+        std::lock_guard<std::mutex> guard(state_lock);
+        stopping = true;
+    }
+    batch_ready.notify_all();
+    for (auto& w : workers) w.join();
+}
+
+// claims tasks of a batch until none are left
+void batch_pool::work(void (*f)(void*, size_t), void* c, const size_t& n){
+    size_t n_finished = 0;
+    for (size_t i = next_task++; i < n; i = next_task++){
+        f(c, i);
+        ++n_finished;
+    }
+    
+    std::lock_guard<std::mutex> guard(state_lock);
+    n_done += n_finished;
+    if (n_done == n_tasks) batch_done.notify_all();
+}
+
+void batch_pool::worker_loop(size_t seen_batch){
+    while (true){
+        void (*f)(void*, size_t);
+        void* c;
+        size_t n;
+        {
+            std::unique_lock<std::mutex> guard(state_lock);
+            batch_ready.wait(guard, [&]{return stopping || (batch_id != seen_batch);});
+            if (stopping) return;
+            seen_batch = batch_id;
+            f = fn;
+            c = ctx;
+            n = n_tasks;
+            ++n_active;
+        }
+        
+        work(f, c, n);
+        
+        std::lock_guard<std::mutex> guard(state_lock);
+        --n_active;
+        batch_done.notify_all();
+    }
+}
+
+void batch_pool::run_batch(const size_t& n, void (*f)(void*, size_t), void* c){
+    std::unique_lock<std::mutex> batch_guard(batch_lock, std::try_to_lock);
+    
+    // the pool is busy with another search, so this one runs on the calling thread
+    if (!batch_guard.owns_lock() || (n_threads <= 1) || (n <= 1)){
+        for (size_t i = 0; i < n; ++i) f(c, i);
+        return;
+    }
+    
+    {
+        // workers still holding the previous batch must let go before its fields are overwritten
+        std::unique_lock<std::mutex> guard(state_lock);
+        batch_done.wait(guard, [&]{return n_active == 0;});
+        if (workers.empty()){
+            for (size_t i = 1; i < n_threads; ++i) workers.emplace_back(&batch_pool::worker_loop, this, batch_id);
+        }
+        fn = f;
+        ctx = c;
+        n_tasks = n;
+        n_done = 0;
+        next_task = 0;
+        ++batch_id;
+    }
+    batch_ready.notify_all();
+    
+    work(f, c, n);
+    
+    std::unique_lock<std::mutex> guard(state_lock);
+    batch_done.wait(guard, [&]{return (n_done == n_tasks) && (n_active == 0);});
+}
@@ -0,0 +1,120 @@
+#include "trans_cache.hpp"
+#include <cstring>
+
+const size_t TRANS_CACHE_MIN_LOG2 = 10; // 64KB
+const size_t TRANS_CACHE_MAX_LOG2 = 18; // 16MB, 1048576 entries
+const size_t TRANS_CACHE_WAYS = 4;
+
+u_int16_t quantize_prob(const float& p){
+    u_int32_t bits;
+    std::memcpy(&bits, &p, sizeof(bits));
+    return (bits + 0xffff) >> 16;
+}
+
+trans_cache::trans_cache(search_arena& arena, const size_t& buckets_log2, const size_t& max_log2) : arena(arena), min_log2(buckets_log2), max_log2(max_log2), limit_log2(max_log2), n_entries(0), age(arena.generation()) {
+    assert ((buckets_log2 > 0) && (buckets_log2 <= max_log2) && (max_log2 < 32));
+    buckets = allocate(buckets_log2);
+    if (!buckets) throw std::bad_alloc();
+    shift = 64 - buckets_log2;
+}
+
+void trans_cache::reset(){
+    arena.reset();
+    age = arena.generation();
+    max_log2 = limit_log2;
+    n_entries = 0;
+    buckets = allocate(min_log2);
+    if (!buckets) throw std::bad_alloc();
+    shift = 64 - min_log2;
+}
+
+cache_bucket* trans_cache::allocate(const size_t& buckets_log2){
+    
+    // arena memory holds entries of earlier searches, which read as empty since their age differs
+    return (cache_bucket*) arena.allocate(sizeof(cache_bucket) << buckets_log2, 64);
+}
+
+void trans_cache::grow(){
+    cache_bucket* new_buckets = allocate(65 - shift);
+    
+    // keeps replacing entries at the current size once the arena is full
+    if (!new_buckets){
+        max_log2 = 64 - shift;
+        return;
+    }
+    
+    cache_bucket* old_buckets = buckets;
+    size_t n_old = (size_t) 1 << (64 - shift);
+    buckets = new_buckets;
+    --shift;
+    n_entries = 0;
+    
+    for (size_t i = 0; i < n_old; ++i){
+        for (auto& e : old_buckets[i].entries){
+            if ((e.data >> 56) != age) continue;
+            
+            // each new bucket takes the entries of a single old bucket, so they always fit
+            place(e.check ^ e.data, e.data);
+        }
+    }
+}
+
+bool trans_cache::find(const board_t& board, const int& depth, const float& min_prob, float& val) const {
+    const cache_bucket& b = bucket(board);
+    u_int16_t q = quantize_prob(min_prob);
+    
+    for (size_t i = 0; i < TRANS_CACHE_WAYS; ++i){
+        u_int64_t data = b.entries[i].data;
+        if ((b.entries[i].check ^ data) != board) continue;
+        if ((data >> 56) != age) continue;
+        
+        // only returns values calculated to at least the current specified depth and accuracy
+        if ((int) ((data >> 48) & 0xff) < depth) return false;
+        if (((data >> 32) & 0xffff) > q) return false;
+        
+        u_int32_t bits = (u_int32_t) data;
+        std::memcpy(&val, &bits, sizeof(val));
+        return true;
+    }
+    return false;
+}
+
+void trans_cache::place(const board_t& board, const u_int64_t& data){
+    cache_bucket& b = bucket(board);
+    
+    // replaces the same board, else an entry from an older generation, else the shallowest entry
+    size_t victim = 0;
+    int victim_depth = 256;
+    for (size_t i = 0; i < TRANS_CACHE_WAYS; ++i){
+        u_int64_t old_data = b.entries[i].data;
+        bool stale = (old_data >> 56) != age;
+        if (stale || ((b.entries[i].check ^ old_data) == board)){
+            victim = i;
+            n_entries += stale;
+            break;
+        }
+        int d = (old_data >> 48) & 0xff;
+        if (d < victim_depth){
+            victim = i;
+            victim_depth = d;
+        }
+    }
+    
+    b.entries[victim].data = data;
+    b.entries[victim].check = board ^ data;
+}
+
+void trans_cache::insert(const board_t& board, const int& depth, const float& min_prob, const float& val){
+    u_int32_t bits;
+    std::memcpy(&bits, &val, sizeof(bits));
+    place(board, bits
+    | ((u_int64_t) quantize_prob(min_prob) << 32)
+    | ((u_int64_t) (depth & 0xff) << 48)
+    | ((u_int64_t) age << 56));
+    
+    if ((2 * n_entries > (TRANS_CACHE_WAYS << (64 - shift))) && (64 - shift < max_log2)) grow();
+}
+
+size_t trans_cache::size_bytes() const {
+    return sizeof(cache_bucket) << (64 - shift);
+}
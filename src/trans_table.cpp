@@ -1,4 +1,5 @@
 #include "trans_table.hpp"
+#include <cstring>
 
 const size_t MAX_DEPTH = 16;
 const bool MULTITHREADED = true;
@@ -13,6 +14,41 @@ T max6(const T& x0, const T& x1, const T& x2, const T& x3, const T& x4, const T&
     return std::max(std::max(std::max(x0, x1), std::max(x2, x3)), std::max(x4, x5));
 }
 
+// rounds to the nearest half precision value, values are pre-scaled into range
+u_int16_t float_to_half(const float& f){
+    u_int16_t sign = std::signbit(f) ? 0x8000 : 0;
+    float a = std::min(std::abs(f), 65504.0f);
+    
+    // subnormal halves are multiples of 2^-24
+    if (a < 6.103515625e-05f) return sign | (u_int16_t) lrintf(a * 16777216.0f);
+    
+    int e;
+    float m = frexpf(a, &e);
+    u_int32_t mantissa = lrintf((2 * m - 1) * 1024);
+    u_int32_t exponent = e + 14;
+    if (mantissa == 1024){
+        mantissa = 0;
+        ++exponent;
+    }
+    return sign | (u_int16_t) ((exponent << 10) | mantissa);
+}
+
+float _half_to_float(const u_int16_t& h){
+    u_int32_t sign = (u_int32_t) (h & 0x8000) << 16;
+    u_int32_t exponent = (h >> 10) & 0x1f;
+    u_int32_t mantissa = h & 0x3ff;
+    
+    if (exponent == 0){
+        float res = mantissa * 5.9604644775390625e-08f;
+        return sign ? -res : res;
+    }
+    
+    u_int32_t bits = sign | ((exponent + 112) << 23) | (mantissa << 13);
+    float res;
+    std::memcpy(&res, &bits, 4);
+    return res;
+}
+
 // rotates and flips board in 4d to an equivalent board to make it easier to calculate heuristic
 board_t reorganize(const board_t& board, const size_t& level){
     board_t res = board;
@@ -108,37 +144,154 @@ board_t reorganize(const board_t& board, const size_t& level){
     }
 }
 
-trans_table::trans_table(const std::vector<float>& params) : b_eval_count(0) {
-    this->params = params;
+// nibble permutations of every symmetry reorganize can compose, indexed by
+// [max tile location][edge choice][square choice][cube choice]
+struct reorganize_perm_t {
+    alignas(16) u_int8_t perms[16][4][3][2][16];
     
-    std::vector<board_t> arr;
-    board_t row;
-    for (board_t x0 = 0; x0 < 16; ++x0){
-        for (board_t x1 = 0; x1 < 16; ++x1){
-            for (board_t x2 = 0; x2 < 16; ++x2){
-                for (board_t x3 = 0; x3 < 16; ++x3){
-                    arr = {x3, x2, x1, x0};
-                    row = arr_to_row_transition(arr);
+    reorganize_perm_t(){
+        
+        // applying the symmetries to a board holding each location's index records where every nibble comes from
+        const board_t index_board = 0x0123456789abcdef;
+        
+        for (size_t m = 0; m < 16; ++m){
+            board_t b0 = index_board;
+            for (int idx = 0; idx < 4; ++idx) if ((m >> idx) & 1) b0 = flip(b0, 3-idx);
+            
+            for (size_t c1 = 0; c1 < 4; ++c1){
+                board_t b1 = (c1 == 1) ? swap_2_3(b0) : (c1 == 2) ? swap_1_3(b0) : (c1 == 3) ? swap_0_3(b0) : b0;
+                
+                for (size_t c2 = 0; c2 < 3; ++c2){
+                    board_t b2 = (c2 == 1) ? swap_1_2(b1) : (c2 == 2) ? swap_0_2(b1) : b1;
                     
-                    _partial_square_row[row] = params[2] * (row_pow_val[row] + params[4] * row_edge_val[row]);
-                    _aug_partial_square_row[row] = params[3] * _partial_square_row[row];
-                    _partial_heuristic[row] = 6 * (params[0] * n_row_merges[row] + params[1] * zero_count(arr));
-                    _aug_row_mon_vals[row] = params[5] * row_mon_vals[row];
+                    for (size_t c3 = 0; c3 < 2; ++c3){
+                        board_t b3 = c3 ? swap_0_1(b2) : b2;
+                        
+                        // locations count from the most significant nibble, permutations from the least
+                        for (size_t i = 0; i < 16; ++i) perms[m][c1][c2][c3][i] = 15 - ((b3 >> (4 * i)) & 0xf);
+                    }
                 }
             }
         }
     }
+};
+
+const reorganize_perm_t REORGANIZE_PERMS;
+
+// value of the nibble of the original board that a permutation moves to nibble i
+constexpr size_t permuted_nibble(const board_t& board, const u_int8_t* perm, const size_t& i){
+    return (board >> (4 * perm[i])) & 0xf;
+}
+
+constexpr size_t nibble_score(const size_t& val){
+    return val << val;
+}
+
+board_t fast_reorganize(const board_t& board){
+    
+    // Corner optimisation: highest (value, location) key over the four rows
+    size_t key0 = row_max_key[ROW_MASK & board] | 12;
+    size_t key1 = row_max_key[ROW_MASK & (board >> 16)] | 8;
+    size_t key2 = row_max_key[ROW_MASK & (board >> 32)] | 4;
+    size_t key3 = row_max_key[ROW_MASK & (board >> 48)];
+    size_t m = max4(key0, key1, key2, key3) & 0xf;
+    
+    // Edge rearrangement: neighbours of the max tile are at locations m^1, m^2, m^4, m^8
+    size_t second_rank = nibble_at(board, m ^ 1);
+    size_t c1 = 0;
+    size_t tmp_size;
+    if ((tmp_size = nibble_at(board, m ^ 2)) > second_rank){second_rank = tmp_size; c1 = 1;}
+    if ((tmp_size = nibble_at(board, m ^ 4)) > second_rank){second_rank = tmp_size; c1 = 2;}
+    if ((tmp_size = nibble_at(board, m ^ 8)) > second_rank){c1 = 3;}
+    
+    // Square rearrangement, reading the edges through the permutation so far
+    const u_int8_t* p1 = REORGANIZE_PERMS.perms[m][c1][0][0];
+    size_t edge_val = nibble_score(permuted_nibble(board, p1, 12)) + nibble_score(permuted_nibble(board, p1, 13));
+    size_t tmp_val;
+    size_t c2 = 0;
+    if ((tmp_val = nibble_score(permuted_nibble(board, p1, 10)) + nibble_score(permuted_nibble(board, p1, 11))) > edge_val){edge_val = tmp_val; c2 = 1;}
+    if ((tmp_val = nibble_score(permuted_nibble(board, p1, 6)) + nibble_score(permuted_nibble(board, p1, 7))) > edge_val){c2 = 2;}
+    
+    // Cube rearrangement
+    const u_int8_t* p2 = REORGANIZE_PERMS.perms[m][c1][c2][0];
+    size_t lower_square = 0;
+    size_t upper_square = 0;
+    for (size_t i = 4; i < 8; ++i) lower_square += nibble_score(permuted_nibble(board, p2, i));
+    for (size_t i = 8; i < 12; ++i) upper_square += nibble_score(permuted_nibble(board, p2, i));
+    size_t c3 = lower_square > upper_square;
+    
+    return KERNELS.permute(board, REORGANIZE_PERMS.perms[m][c1][c2][c3]);
+}
+
+trans_table::trans_table(const std::vector<float>& params, const size_t& n_root_workers) : b_eval_count(0), root_workers(n_root_workers ? n_root_workers : std::min(8u, std::max(1u, std::thread::hardware_concurrency()))), leaf_lookups(0), leaf_hits(0) {
+    set_params(params);
+}
+
+void trans_table::set_params(const std::vector<float>& params){
+    this->params = params;
+    leaf_generation = next_leaf_generation();
+    
+    const float merge_weight = params[0];
+    const float blank_weight = params[1];
+    const float cube_weight = params[2];
+    const float square_weight = params[3];
+    const float edge_weight = params[4];
+    const float mon_weight = params[5];
+    
+    // each value is a single pass over contiguous feature arrays, which the compiler vectorizes.
+    // the columns are scratch space kept per thread, since tuners call this once per candidate
+    static thread_local std::vector<float> columns(3 * 65536);
+    float* top = columns.data();
+    float* second = top + 65536;
+    float* partial = second + 65536;
+    
+    for (size_t row = 0; row < 65536; ++row){
+        float partial_square = cube_weight * (row_pow_val[row] + edge_weight * row_edge_val[row]);
+        float aug_row_mon = mon_weight * row_mon_vals[row];
+        top[row] = square_weight * partial_square - aug_row_mon;
+        second[row] = partial_square - aug_row_mon;
+    }
+    
+    for (size_t row = 0; row < 65536; ++row){
+        partial[row] = 6 * (merge_weight * n_row_merges[row] + blank_weight * row_zero_count[row]);
+    }
+    
+#ifdef HEURISTIC_FLOAT16
+    // power of two scales keep the largest value of each column inside the half precision range
+    auto scale = [](const float* vals){
+        float max_abs = 0;
+        for (size_t row = 0; row < 65536; ++row) max_abs = std::max(max_abs, std::abs(vals[row]));
+        return std::max(1.0f, exp2f(ceilf(log2f(max_abs / 32768))));
+    };
+    _top_scale = scale(top);
+    _second_scale = scale(second);
+    _partial_scale = scale(partial);
+    
+    for (size_t row = 0; row < 65536; ++row){
+        _rows[row] = {
+            float_to_half(top[row] / _top_scale),
+            float_to_half(second[row] / _second_scale),
+            float_to_half(partial[row] / _partial_scale),
+            0};
+    }
+#else
+    for (size_t row = 0; row < 65536; ++row){
+        _rows[row] = {top[row], second[row], partial[row], 0};
+    }
+#endif
+}
+
+const std::vector<float>& trans_table::get_params() const {
+    return params;
 }
 
 float trans_table::non_terminal_heuristic(const board_t& board) const {
-    return reorganized_heuristic(reorganize(board, 0));
+    return reorganized_heuristic(fast_reorganize(board));
 }
 
 float trans_table::reorganized_heuristic(const board_t& board) const {
-    return _aug_partial_square_row[ROW_MASK & (board >> 48)]
-    + _partial_square_row[ROW_MASK & (board >> 32)]
-    - _aug_row_mon_vals[ROW_MASK & (board >> 48)]
-    - _aug_row_mon_vals[ROW_MASK & (board >> 32)]
+    return top_val(ROW_MASK & (board >> 48))
+    + second_val(ROW_MASK & (board >> 32))
     + secondary_cube_heuristic(board);
 }
 
@@ -147,9 +300,9 @@ float trans_table::secondary_cube_heuristic(const board_t& board) const {
     board_t board1 = swap_1_2(board);
     board_t board2 = swap_1_3(board);
     
-    float score0 = _partial_heuristic[ROW_MASK & board0] + _partial_heuristic[ROW_MASK & (board0 >> 16)];
-    float score1 = _partial_heuristic[ROW_MASK & board1] + _partial_heuristic[ROW_MASK & (board1 >> 16)];
-    float score2 = _partial_heuristic[ROW_MASK & board2] + _partial_heuristic[ROW_MASK & (board2 >> 16)];
+    float score0 = partial_val(ROW_MASK & board0) + partial_val(ROW_MASK & (board0 >> 16));
+    float score1 = partial_val(ROW_MASK & board1) + partial_val(ROW_MASK & (board1 >> 16));
+    float score2 = partial_val(ROW_MASK & board2) + partial_val(ROW_MASK & (board2 >> 16));
     
     return std::max(std::max(score0, score1), score2);
 }
@@ -158,25 +311,40 @@ float trans_table::heuristic(const board_t& board) const {
     return non_terminal_heuristic(board) - LOSS_PENALTY * _is_terminal(board);
 }
 
+float trans_table::leaf_heuristic(const board_t& board) const {
+    if (!cache_leaves) return non_terminal_heuristic(board);
+    
+    leaf_cache& leaves = thread_leaf_cache();
+    float res;
+    if (leaves.find(board, leaf_generation, res)) return res;
+    
+    res = non_terminal_heuristic(board);
+    leaves.insert(board, leaf_generation, res);
+    return res;
+}
+
 // move node in expectimax
 float trans_table::move_node(const board_t& board, const int& depth, const float& prob, cached_emax_states_t& cached_emax_values, const float& min_prob){
     ++b_eval_count;
     float res = -INFINITY;
 
     // pick move with greatest expected utility
-    int idx = 0;
-    u_int16_t move_mask = _valid_move_mask(board);
+    board_t children[8];
+    u_int16_t move_mask = KERNELS.successors(board, children);
 
     // if there are no valid moves, return heuristic
     if (move_mask == 0){
         return heuristic(board);
     }
     
+    // children at expanded depths are looked up in the cache, so their buckets are requested before recursing
+    if ((depth > 0) && (prob >= min_prob)){
+        for (u_int16_t m = move_mask; m; m &= m - 1) cached_emax_values.prefetch(children[__builtin_ctz(m)]);
+    }
+    
     // iterates over valid move set
-    for (int i = 0; move_mask; ++i, move_mask >>= 1) {
-        if (move_mask & 1) {
-            res = std::max(res, expectation_node(_shift_board(board, DIRECTIONS[i]), depth, prob, cached_emax_values, min_prob));
-        }
+    for (; move_mask; move_mask &= move_mask - 1) {
+        res = std::max(res, expectation_node(children[__builtin_ctz(move_mask)], depth, prob, cached_emax_values, min_prob));
     }
     
     return res;
@@ -184,70 +352,82 @@ float trans_table::move_node(const board_t& board, const int& depth, const float
 
 // expectation node in expectimax
 float trans_table::expectation_node(const board_t& board, const int& depth, const float& prob, cached_emax_states_t& cached_emax_values, const float& min_prob){
-    cached_emax_states_t::iterator address;
     ++b_eval_count;
     
     if ((prob < min_prob) || (depth <= 0)){
         
         // final layer
         // board cannot be terminal if entered from a move node
-        return non_terminal_heuristic(board);
+        return leaf_heuristic(board);
         
     } else {
         
-        auto address = cached_emax_values[depth].find(board);
-        
-        // cached expectation layer score
-        if (address != cached_emax_values[depth].end()){
-            
-            {
-                // only returns cached values that are calculated to at least the current specified accuracy
-                if (address->second.min_prob <= min_prob){
-
-                    return address->second.val;
-                }
-            }
-
+        // cached expectation layer score, only if calculated to at least the current specified depth and accuracy
+        float res = 0;
+        if (cached_emax_values.find(board, depth, min_prob, res)){
+            return res;
         }
         
         // uncached expectation layer
-        float res = 0;
         board_t free_tiles = is_blank(board);
         
-        int n_empty_tiles = popcount(free_tiles);
+        int n_empty_tiles = KERNELS.count_blanks(board);
+        
+        // crowded positions lost under every spawn are scored without expanding them
+        if (prove_losses && near_terminal(n_empty_tiles) && proven_lost(board, std::min(depth, PROOF_DEPTH))){
+            res = non_terminal_heuristic(board) - LOSS_PENALTY;
+            cached_emax_values.insert(board, depth, min_prob, res);
+            return res;
+        }
+        
         float factor = prob / n_empty_tiles;
         
+        // spawns equivalent under the board's symmetries are searched once and weighted by their number,
+        // failing that, open boards can search a sample of their spawns weighted by the cells each one stands for
+        u_int8_t weights[16];
+        bool weighted = (collapse_symmetries && (depth >= SYMMETRY_MIN_DEPTH) && collapse_spawns(board, free_tiles, weights))
+        || (spawn_samples && (depth >= SAMPLE_MIN_DEPTH) && sample_spawns(board, spawn_samples, free_tiles, weights));
+        
         // iterates over empty tiles
-        for (board_t randomSetBit = 1; free_tiles; free_tiles >>= 4, randomSetBit <<= 4){
+        for (board_t randomSetBit = 1, cell = 0; free_tiles; free_tiles >>= 4, randomSetBit <<= 4, ++cell){
             
             if (free_tiles & 1){
+                float weight = weighted ? weights[cell] : 1;
                 
                 // places 2 in free tile
-                res += 0.9 * move_node(board | randomSetBit, depth-1, 0.9 * factor, cached_emax_values, min_prob);
+                res += weight * 0.9 * move_node(board | randomSetBit, depth-1, 0.9 * factor, cached_emax_values, min_prob);
                 
                 // places 4 in free tile
-                res += 0.1 * move_node(board | (randomSetBit << 1), depth-1, 0.1 * factor, cached_emax_values, min_prob);
+                res += weight * 0.1 * move_node(board | (randomSetBit << 1), depth-1, 0.1 * factor, cached_emax_values, min_prob);
                 
             }
         }
         
         res /= n_empty_tiles;
         
-        cached_emax_values[depth][board] = {res, min_prob};
+        cached_emax_values.insert(board, depth, min_prob, res);
         return res;
     }
 }
 
 // entry node  used in multithreaded expectimax
 float trans_table::entry_node(const board_t& board, const int& depth, const float& prob, const float& min_prob){
-    cached_emax_states_t cached_emax_values = cached_emax_states_t(MAX_DEPTH);
-    return expectation_node(board, depth, 1.0, cached_emax_values, min_prob);
+    arena_ptr arena = arenas.acquire();
+    cached_emax_states_t cached_emax_values(*arena);
+    float res = expectation_node(board, depth, 1.0, cached_emax_values, min_prob);
+    thread_leaf_cache().flush_stats(leaf_lookups, leaf_hits);
+    return res;
 }
 
 DIRECTION trans_table::expectimax(const Board& board, const int& depth, const float& min_prob){
+    return expectimax(board, depth, min_prob, nullptr);
+}
+
+DIRECTION trans_table::expectimax(const Board& board, const int& depth, const float& min_prob, const root_scores* known){
     
-    std::vector<DIRECTION> moves = board.valid_moves();
+    move_list moves = board.valid_moves();
     assert (moves.size() > 0);
+    assert ((depth >= 0) && (depth < (int) MAX_DEPTH));
     
     // forces board to make 65536 if it can
     if (_count(board.board, 15) == 2){
@@ -258,44 +438,52 @@ DIRECTION trans_table::expectimax(const Board& board, const int& depth, const fl
         }
     }
     
-    // returns argmax
-    std::vector<move_state> move_scores;
+    // one score per valid move, in the order of moves
+    float move_scores[8];
+    u_int16_t known_mask = (known && known->matches(board.board, depth, min_prob)) ? known->known_mask : 0;
+    
+    // moves equivalent under the board's symmetries take the score of the lowest of them
+    DIRECTION reps[8];
+    bool symmetric = collapse_symmetries && collapse_moves(board.board, reps);
+    u_int16_t search_mask = 0;
+    for (auto move : moves) search_mask |= 1 << (symmetric ? reps[move] : move);
 
     if (MULTITHREADED) {
         
-        std::unordered_map<DIRECTION, std::future<float>> parallel_move_scores;
-        
-        for (auto move : moves){
-    
-            std::future<float> fut = std::async(
-                std::launch::async, &trans_table::entry_node, this, _shift_board(board.board, move), depth, 1.0, min_prob);
-            
-            parallel_move_scores[move] = std::move(fut);
-        }
-        
-        for (auto move : moves){
-            move_scores.push_back({move, parallel_move_scores[move].get()});
-        }
+        auto search = [&](size_t i){
+            if (!(search_mask & (1 << moves[i]))) return;
+            if (known_mask & (1 << moves[i])) move_scores[i] = known->scores[moves[i]];
+            else move_scores[i] = entry_node(_shift_board(board.board, moves[i]), depth, 1.0, min_prob);
+        };
+        root_workers.run(moves.size(), search);
 
     } else {
         
-        cached_emax_states_t cached_emax_values = cached_emax_states_t(MAX_DEPTH);
+        arena_ptr arena = arenas.acquire();
+        cached_emax_states_t cached_emax_values(*arena);
         
-        for (auto move : moves){
-            
-            float next_score = expectation_node(_shift_board(board.board, move), depth, 1.0, cached_emax_values, min_prob);
-            
-            move_scores.push_back({move, next_score});
+        for (size_t i = 0; i < moves.size(); ++i){
+            if (!(search_mask & (1 << moves[i]))) continue;
+            if (known_mask & (1 << moves[i])) move_scores[i] = known->scores[moves[i]];
+            else move_scores[i] = expectation_node(_shift_board(board.board, moves[i]), depth, 1.0, cached_emax_values, min_prob);
+        }
+        thread_leaf_cache().flush_stats(leaf_lookups, leaf_hits);
+    }
+    
+    if (symmetric){
+        for (size_t i = 0; i < moves.size(); ++i){
+            for (size_t j = 0; j < i; ++j) if (moves[j] == reps[moves[i]]) move_scores[i] = move_scores[j];
         }
     }
     
+    // returns argmax
     float best_score = -INFINITY;
     DIRECTION res = moves[0];
     
-    for (auto ms : move_scores){
-        if (ms.emax_val > best_score){
-            best_score = ms.emax_val;
-            res = ms.move;
+    for (size_t i = 0; i < moves.size(); ++i){
+        if (move_scores[i] > best_score){
+            best_score = move_scores[i];
+            res = moves[i];
         }
     }
     
@@ -319,49 +507,31 @@ long long trans_table::mcts_score(const Board& board, const DIRECTION& move, con
 }
 
 DIRECTION trans_table::mcts(const Board& board, const size_t& n_sims){
-    std::vector<DIRECTION> moves = board.valid_moves();
+    move_list moves = board.valid_moves();
     assert (moves.size() > 0);
     
-    DIRECTION res = moves[0];
+    long long move_scores[8];
     
     if (MULTITHREADED) {
         
-        robin_hood::unordered_map<DIRECTION, std::future<long long>> parallel_move_scores;
-        
-        for (auto move : moves){
-    
-            std::future<long long> fut = std::async(
-                std::launch::async, &trans_table::mcts_score, this, board,  move, n_sims);
-            
-            parallel_move_scores[move] = std::move(fut);
-        }
-        
-        long long best_score = 0;
-        
-        for (auto move : moves){
-            long long tmp_score = parallel_move_scores[move].get();
-            
-            if (tmp_score > best_score){
-                best_score = tmp_score;
-                res = move;
-            }
-        }
-        
-        return res;
+        auto simulate = [&](size_t i){
+            move_scores[i] = mcts_score(board, moves[i], n_sims);
+        };
+        root_workers.run(moves.size(), simulate);
         
     } else {
-        long long best_score = 0;
-        
-        for (auto move : moves){
-            
-            long long tmp_score = mcts_score(board, move, n_sims);
-            
-            if (tmp_score > best_score){
-                best_score = tmp_score;
-                res = move;
-            }
+        for (size_t i = 0; i < moves.size(); ++i) move_scores[i] = mcts_score(board, moves[i], n_sims);
+    }
+    
+    DIRECTION res = moves[0];
+    long long best_score = 0;
+    
+    for (size_t i = 0; i < moves.size(); ++i){
+        if (move_scores[i] > best_score){
+            best_score = move_scores[i];
+            res = moves[i];
         }
-        
-        return res;
     }
+    
+    return res;
 }
@@ -0,0 +1,275 @@
+#include "tuner.hpp"
+
+// eigendecomposition of a symmetric matrix by cyclic Jacobi rotations
+void jacobi_eigen(std::vector<std::vector<double>> a, std::vector<double>& vals, std::vector<std::vector<double>>& vecs){
+    size_t n = a.size();
+    vecs.assign(n, std::vector<double>(n, 0));
+    for (size_t i = 0; i < n; ++i) vecs[i][i] = 1;
+    
+    for (int sweep = 0; sweep < 100; ++sweep){
+        double off = 0;
+        for (size_t p = 0; p < n; ++p) for (size_t q = p + 1; q < n; ++q) off += a[p][q] * a[p][q];
+        if (off < 1e-30) break;
+        
+        for (size_t p = 0; p < n; ++p){
+            for (size_t q = p + 1; q < n; ++q){
+                if (std::abs(a[p][q]) < 1e-300) continue;
+                double theta = (a[q][q] - a[p][p]) / (2 * a[p][q]);
+                double t = ((theta >= 0) ? 1 : -1) / (std::abs(theta) + sqrt(theta * theta + 1));
+                double c = 1 / sqrt(t * t + 1);
+                double s = t * c;
+                
+                for (size_t k = 0; k < n; ++k){
+                    double akp = a[k][p], akq = a[k][q];
+                    a[k][p] = c * akp - s * akq;
+                    a[k][q] = s * akp + c * akq;
+                }
+                for (size_t k = 0; k < n; ++k){
+                    double apk = a[p][k], aqk = a[q][k];
+                    a[p][k] = c * apk - s * aqk;
+                    a[q][k] = s * apk + c * aqk;
+                }
+                for (size_t k = 0; k < n; ++k){
+                    double vkp = vecs[k][p], vkq = vecs[k][q];
+                    vecs[k][p] = c * vkp - s * vkq;
+                    vecs[k][q] = s * vkp + c * vkq;
+                }
+            }
+        }
+    }
+    
+    vals.resize(n);
+    for (size_t i = 0; i < n; ++i) vals[i] = std::max(a[i][i], 1e-20);
+}
+
+cma_es::cma_es(const std::vector<double>& mean, const double& sigma, size_t lambda, u_int64_t seed) : n(mean.size()), rng(seed), sigma(sigma), mean(mean) {
+    this->lambda = lambda ? lambda : 4 + (size_t) (3 * log(n));
+    set_strategy_params();
+    
+    cov.assign(n, std::vector<double>(n, 0));
+    for (size_t i = 0; i < n; ++i) cov[i][i] = 1;
+    p_sigma.assign(n, 0);
+    p_c.assign(n, 0);
+    update_eigensystem();
+}
+
+// default strategy parameters from Hansen's tutorial, all derived from n and lambda
+void cma_es::set_strategy_params(){
+    mu = lambda / 2;
+    
+    weights.resize(mu);
+    double sum_w = 0, sum_w2 = 0;
+    for (size_t i = 0; i < mu; ++i){
+        weights[i] = log(mu + 0.5) - log(i + 1);
+        sum_w += weights[i];
+    }
+    for (auto& w : weights){
+        w /= sum_w;
+        sum_w2 += w * w;
+    }
+    mu_eff = 1 / sum_w2;
+    
+    c_sigma = (mu_eff + 2) / (n + mu_eff + 5);
+    d_sigma = 1 + 2 * std::max(0.0, sqrt((mu_eff - 1) / (n + 1)) - 1) + c_sigma;
+    c_c = (4 + mu_eff / n) / (n + 4 + 2 * mu_eff / n);
+    c_1 = 2 / ((n + 1.3) * (n + 1.3) + mu_eff);
+    c_mu = std::min(1 - c_1, 2 * (mu_eff - 2 + 1 / mu_eff) / ((n + 2) * (n + 2) + mu_eff));
+    chi_n = sqrt(n) * (1 - 1.0 / (4 * n) + 1.0 / (21 * n * n));
+}
+
+void cma_es::update_eigensystem(){
+    jacobi_eigen(cov, eigen_vals, eigen_vecs);
+}
+
+std::vector<std::vector<double>> cma_es::ask(){
+    std::normal_distribution<double> normal(0, 1);
+    std::vector<std::vector<double>> xs(lambda, std::vector<double>(n));
+    std::vector<double> z(n);
+    
+    // x = m + sigma * B D z
+    for (auto& x : xs){
+        for (auto& zi : z) zi = normal(rng);
+        for (size_t i = 0; i < n; ++i){
+            x[i] = mean[i];
+            for (size_t j = 0; j < n; ++j) x[i] += sigma * eigen_vecs[i][j] * sqrt(eigen_vals[j]) * z[j];
+        }
+    }
+    return xs;
+}
+
+void cma_es::tell(const std::vector<std::vector<double>>& xs, const std::vector<double>& fs){
+    std::vector<size_t> order(xs.size());
+    for (size_t i = 0; i < order.size(); ++i) order[i] = i;
+    std::sort(order.begin(), order.end(), [&](size_t a, size_t b){return fs[a] < fs[b];});
+    
+    if (fs[order[0]] < best_f){
+        best_f = fs[order[0]];
+        best_x = xs[order[0]];
+    }
+    
+    // recombination
+    std::vector<double> old_mean = mean;
+    for (size_t i = 0; i < n; ++i){
+        mean[i] = 0;
+        for (size_t k = 0; k < mu; ++k) mean[i] += weights[k] * xs[order[k]][i];
+    }
+    
+    std::vector<double> y(n);
+    for (size_t i = 0; i < n; ++i) y[i] = (mean[i] - old_mean[i]) / sigma;
+    
+    // C^(-1/2) y = B D^-1 B^T y
+    std::vector<double> bty(n, 0), c_inv_sqrt_y(n, 0);
+    for (size_t j = 0; j < n; ++j) for (size_t i = 0; i < n; ++i) bty[j] += eigen_vecs[i][j] * y[i];
+    for (size_t i = 0; i < n; ++i) for (size_t j = 0; j < n; ++j) c_inv_sqrt_y[i] += eigen_vecs[i][j] * bty[j] / sqrt(eigen_vals[j]);
+    
+    // step size path
+    double norm_p_sigma = 0;
+    for (size_t i = 0; i < n; ++i){
+        p_sigma[i] = (1 - c_sigma) * p_sigma[i] + sqrt(c_sigma * (2 - c_sigma) * mu_eff) * c_inv_sqrt_y[i];
+        norm_p_sigma += p_sigma[i] * p_sigma[i];
+    }
+    norm_p_sigma = sqrt(norm_p_sigma);
+    
+    // covariance path, stalled when the step size path is long
+    double h_sigma_bound = (1.4 + 2.0 / (n + 1)) * chi_n * sqrt(1 - pow(1 - c_sigma, 2 * (generation + 1)));
+    double h_sigma = (norm_p_sigma < h_sigma_bound) ? 1 : 0;
+    for (size_t i = 0; i < n; ++i) p_c[i] = (1 - c_c) * p_c[i] + h_sigma * sqrt(c_c * (2 - c_c) * mu_eff) * y[i];
+    
+    // rank-one and rank-mu covariance update
+    for (size_t i = 0; i < n; ++i){
+        for (size_t j = 0; j < n; ++j){
+            double rank_mu = 0;
+            for (size_t k = 0; k < mu; ++k){
+                rank_mu += weights[k] * (xs[order[k]][i] - old_mean[i]) * (xs[order[k]][j] - old_mean[j]) / (sigma * sigma);
+            }
+            cov[i][j] = (1 - c_1 - c_mu) * cov[i][j]
+                + c_1 * (p_c[i] * p_c[j] + (1 - h_sigma) * c_c * (2 - c_c) * cov[i][j])
+                + c_mu * rank_mu;
+        }
+    }
+    
+    sigma *= exp((c_sigma / d_sigma) * (norm_p_sigma / chi_n - 1));
+    ++generation;
+    update_eigensystem();
+}
+
+void write_vector(std::ostream& os, const std::vector<double>& v){
+    for (auto x : v) os << " " << x;
+    os << std::endl;
+}
+
+void read_vector(std::istream& is, std::vector<double>& v, const size_t& n){
+    v.resize(n);
+    for (auto& x : v) is >> x;
+}
+
+void cma_es::save(std::ostream& os) const {
+    os << std::setprecision(17);
+    os << "cma_es 1 " << n << " " << lambda << " " << generation << " " << sigma << " " << best_f << std::endl;
+    write_vector(os, mean);
+    write_vector(os, p_sigma);
+    write_vector(os, p_c);
+    write_vector(os, best_x.empty() ? mean : best_x);
+    for (auto& row : cov) write_vector(os, row);
+    os << rng << std::endl;
+}
+
+bool cma_es::load(std::istream& is){
+    std::string tag;
+    int version;
+    size_t saved_n;
+    if (!(is >> tag >> version >> saved_n) || (tag != "cma_es") || (version != 1) || (saved_n != n)) return false;
+    
+    is >> lambda >> generation >> sigma >> best_f;
+    read_vector(is, mean, n);
+    read_vector(is, p_sigma, n);
+    read_vector(is, p_c, n);
+    read_vector(is, best_x, n);
+    cov.resize(n);
+    for (auto& row : cov) read_vector(is, row, n);
+    is >> rng;
+    if (!is || (lambda < 2)) return false;
+    
+    // the checkpoint's population replaces the requested one, so everything derived from it is recomputed
+    set_strategy_params();
+    update_eigensystem();
+    return true;
+}
+
+float evaluate_params(trans_table& T, const std::vector<float>& params, const std::vector<tuning_scenario>& scenarios, int depth, float min_prob, size_t n_games, u_int64_t seed){
+    T.set_params(params);
+    float success_counter = 0;
+    
+    for (auto& s : scenarios){
+        for (size_t i = 0; i < n_games; ++i){
+            Board B = play_seeded_game(T, depth, min_prob, s.initial_pos, s.terminal_rank, s.n_gens, seed + i);
+            success_counter += (B.rank() >= s.terminal_rank);
+        }
+    }
+    
+    return success_counter / (n_games * scenarios.size());
+}
+
+std::vector<float> tune_params(const std::vector<float>& initial_params, const std::vector<tuning_scenario>& scenarios, int depth, float min_prob, size_t n_games, size_t n_generations, const std::string& checkpoint_path, const std::string& log_path, size_t population){
+    
+    // searches over log-weights so that every weight stays positive and steps are relative
+    std::vector<double> x0;
+    for (auto p : initial_params) x0.push_back(log(std::max(p, 1e-3f)));
+    cma_es es(x0, 0.3, population, time(NULL));
+    
+    std::ifstream checkpoint_in(checkpoint_path);
+    if (checkpoint_in.is_open() && es.load(checkpoint_in)){
+        std::cout << "Resuming from generation " << es.generation << std::endl;
+    }
+    checkpoint_in.close();
+    
+    // one table per population slot, reweighted in place for every candidate.
+    // candidates already run in parallel, so each table searches its root moves on the calling thread
+    std::vector<std::unique_ptr<trans_table>> tables;
+    for (size_t i = 0; i < es.lambda; ++i) tables.emplace_back(new trans_table(initial_params, 1));
+    
+    std::ofstream log_file(log_path, std::ios::app);
+    if (log_file.tellp() == 0) log_file << "generation,candidate,seed,p0,p1,p2,p3,p4,p5,success_rate" << std::endl;
+    work_stealing_pool pool;
+    
+    auto to_params = [](const std::vector<double>& x){
+        std::vector<float> params;
+        for (auto xi : x) params.push_back((float) exp(xi));
+        return params;
+    };
+    
+    while (es.generation < n_generations){
+        std::vector<std::vector<double>> xs = es.ask();
+        std::vector<double> fs(xs.size());
+        
+        // every candidate in a generation plays the same seeded games
+        u_int64_t seed = 1000003 * (es.generation + 1);
+        
+        for (size_t i = 0; i < xs.size(); ++i){
+            pool.submit([&, i]{
+                fs[i] = -evaluate_params(*tables[i], to_params(xs[i]), scenarios, depth, min_prob, n_games, seed);
+            });
+        }
+        pool.wait();
+        
+        for (size_t i = 0; i < xs.size(); ++i){
+            log_file << es.generation << "," << i << "," << seed;
+            for (auto p : to_params(xs[i])) log_file << "," << p;
+            log_file << "," << -fs[i] << std::endl;
+        }
+        
+        es.tell(xs, fs);
+        
+        // writes the checkpoint atomically so an interrupted run resumes from the last full generation
+        {
+            std::ofstream checkpoint_out(checkpoint_path + ".tmp");
+            es.save(checkpoint_out);
+        }
+        std::rename((checkpoint_path + ".tmp").c_str(), checkpoint_path.c_str());
+        
+        std::cout << "Generation " << es.generation << ": best success rate " << -es.best_f;
+        std::cout << ", params " << to_params(es.best_x) << ", sigma " << es.sigma << std::endl;
+    }
+    
+    return to_params(es.best_x.empty() ? es.mean : es.best_x);
+}